@@ -5,11 +5,53 @@ CONFIG += c++17
 SOURCES += \
     src/qt_main.cpp \
     src/FileConverter.cpp \
-    src/MainWindow.cpp
+    src/FormatSniffer.cpp \
+    src/JsonText.cpp \
+    src/JsonReader.cpp \
+    src/CsvReader.cpp \
+    src/XmlReader.cpp \
+    src/StructuredData.cpp \
+    src/ToolRegistry.cpp \
+    src/TextTransform.cpp \
+    src/ByteReplace.cpp \
+    src/MappedFile.cpp \
+    src/ThreadPool.cpp \
+    src/ConversionProgress.cpp \
+    src/OfficeWorkerPool.cpp \
+    src/ContentHash.cpp \
+    src/ConversionCache.cpp \
+    src/ResourceScheduler.cpp \
+    src/ConversionMetrics.cpp \
+    src/ImageCodec.cpp \
+    src/RemuxPlanner.cpp \
+    src/MainWindow.cpp \
+    src/ConversionWorker.cpp
 
 HEADERS += \
     include/FileConverter.h \
-    src/MainWindow.h
+    include/FormatTable.h \
+    include/FormatSniffer.h \
+    include/JsonText.h \
+    include/JsonReader.h \
+    include/CsvReader.h \
+    include/XmlReader.h \
+    include/StructuredData.h \
+    include/Utf8.h \
+    include/ToolRegistry.h \
+    include/TextTransform.h \
+    include/ByteReplace.h \
+    include/MappedFile.h \
+    include/ThreadPool.h \
+    include/ConversionProgress.h \
+    include/OfficeWorkerPool.h \
+    include/ContentHash.h \
+    include/ConversionCache.h \
+    include/ResourceScheduler.h \
+    include/ConversionMetrics.h \
+    include/ImageCodec.h \
+    include/RemuxPlanner.h \
+    src/MainWindow.h \
+    src/ConversionWorker.h
 
 FORMS += \
     src/MainWindow.ui
@@ -0,0 +1,71 @@
+// Scaling benchmark for the quote-aware CSV to text transform.
+// Writes a CSV file with quoted fields, converts it with csvToTextFile on 1, 2,
+// 4, ... worker threads up to the hardware thread count and reports GB/s of
+// input and the speedup over one thread.
+#include "../include/TextTransform.h"
+#include "../include/ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+namespace {
+
+void writeCsv(const std::string& path, std::size_t bytes) {
+    std::ofstream csv(path, std::ios::binary);
+    std::string row;
+    std::size_t written = 0;
+    for (std::size_t i = 0; written < bytes; ++i) {
+        row = std::to_string(i) + ",User " + std::to_string(i) + ",user" + std::to_string(i) +
+              "@example.com," + std::to_string(i * 7919 % 1000) + ",\"said \"\"hello\"\", then left\"\n";
+        csv << row;
+        written += row.size();
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::size_t megabytes = (argc > 1) ? static_cast<std::size_t>(std::atoi(argv[1])) : 1024;
+    int runs = (argc > 2) ? std::atoi(argv[2]) : 3;
+    std::size_t maxThreads = converter::ThreadPool::defaultThreadCount();
+    
+    writeCsv("bench_data.csv", megabytes << 20);
+    std::cout << "Input: " << megabytes << " MiB, best of " << runs << " runs, "
+              << maxThreads << " hardware threads" << std::endl;
+    
+    std::vector<std::size_t> threadCounts;
+    for (std::size_t threads = 1; threads < maxThreads; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(maxThreads);
+    
+    double single = 0.0;
+    for (std::size_t threads : threadCounts) {
+        double best = 0.0;
+        for (int i = 0; i < runs; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            if (!converter::csvToTextFile("bench_data.csv", "bench_data.txt", threads)) {
+                std::cerr << "Conversion failed" << std::endl;
+                return 1;
+            }
+            auto end = std::chrono::steady_clock::now();
+            double seconds = std::chrono::duration<double>(end - start).count();
+            best = std::max(best, static_cast<double>(megabytes << 20) / seconds / 1e9);
+        }
+        if (single == 0.0) {
+            single = best;
+        }
+        std::cout << std::setw(3) << threads << " threads" << std::setw(8) << std::fixed << std::setprecision(2)
+                  << best << " GB/s" << std::setw(8) << std::setprecision(1) << (best / single) << "x" << std::endl;
+    }
+    
+    std::remove("bench_data.csv");
+    std::remove("bench_data.txt");
+    return 0;
+}
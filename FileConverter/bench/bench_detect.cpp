@@ -0,0 +1,143 @@
+// Microbenchmark for format detection.
+// Writes a corpus of small files whose content matches a random format, a
+// share of them saved under a wrong extension, then compares the old chain of
+// extension comparisons, the extension table and full content sniffing by
+// time per file and by how many files each method identifies correctly.
+#include "../include/FormatSniffer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using converter::FileFormat;
+
+struct Sample {
+    FileFormat format;
+    const char* extension;
+    std::string header;
+};
+
+// Leading bytes of real files, padded to a plausible header length
+std::vector<Sample> makeSamples() {
+    std::string zipOdt("PK\x03\x04", 4);
+    zipOdt += std::string(26, '\0') + "mimetypeapplication/vnd.oasis.opendocument.text";
+    std::string bmp("BM", 2);
+    bmp += std::string(12, '\0') + std::string("\x28\0\0\0", 4);
+
+    return {
+        {FileFormat::PNG, ".png", std::string("\x89PNG\r\n\x1A\n\0\0\0\rIHDR", 16)},
+        {FileFormat::JPG, ".jpg", std::string("\xFF\xD8\xFF\xE0\0\x10JFIF", 10)},
+        {FileFormat::GIF, ".gif", "GIF89a"},
+        {FileFormat::BMP, ".bmp", bmp},
+        {FileFormat::PDF, ".pdf", "%PDF-1.7\n"},
+        {FileFormat::DOCX, ".docx", std::string("PK\x03\x04", 4) + std::string(26, '\0') + "word/document.xml"},
+        {FileFormat::ODT, ".odt", zipOdt},
+        {FileFormat::WAV, ".wav", std::string("RIFF\0\0\0\0WAVEfmt ", 16)},
+        {FileFormat::AVI, ".avi", std::string("RIFF\0\0\0\0AVI LIST", 16)},
+        {FileFormat::MP4, ".mp4", std::string("\0\0\0\x20" "ftypisom", 12)},
+        {FileFormat::MOV, ".mov", std::string("\0\0\0\x14" "ftypqt  ", 12)},
+        {FileFormat::MKV, ".mkv", std::string("\x1A\x45\xDF\xA3\x9F\x42\x82\x88matroska", 16)},
+        {FileFormat::WEBM, ".webm", std::string("\x1A\x45\xDF\xA3\x9F\x42\x82\x84webm", 12)},
+        {FileFormat::MP3, ".mp3", "ID3\x04"},
+        {FileFormat::FLAC, ".flac", "fLaC"},
+        {FileFormat::OGG, ".ogg", "OggS"},
+        {FileFormat::JSON, ".json", "{\"name\": \"value\"}"},
+        {FileFormat::XML, ".xml", "<?xml version=\"1.0\"?><root/>"},
+    };
+}
+
+// Detection as it was before the lookup table: one comparison per extension
+FileFormat chainedExtension(const std::string& filename) {
+    std::string extension;
+    std::size_t pos = filename.find_last_of('.');
+    if (pos != std::string::npos) {
+        extension = filename.substr(pos);
+    }
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+
+    const std::pair<const char*, FileFormat> chain[] = {
+        {".txt", FileFormat::TXT}, {".csv", FileFormat::CSV}, {".json", FileFormat::JSON},
+        {".xml", FileFormat::XML}, {".html", FileFormat::HTML}, {".md", FileFormat::MD},
+        {".jpg", FileFormat::JPG}, {".jpeg", FileFormat::JPG}, {".png", FileFormat::PNG},
+        {".gif", FileFormat::GIF}, {".bmp", FileFormat::BMP}, {".tiff", FileFormat::TIFF},
+        {".tif", FileFormat::TIFF}, {".webp", FileFormat::WEBP}, {".svg", FileFormat::SVG},
+        {".ico", FileFormat::ICO}, {".mp4", FileFormat::MP4}, {".avi", FileFormat::AVI},
+        {".mov", FileFormat::MOV}, {".mkv", FileFormat::MKV}, {".wmv", FileFormat::WMV},
+        {".flv", FileFormat::FLV}, {".webm", FileFormat::WEBM}, {".m4v", FileFormat::M4V},
+        {".mp3", FileFormat::MP3}, {".wav", FileFormat::WAV}, {".aac", FileFormat::AAC},
+        {".flac", FileFormat::FLAC}, {".ogg", FileFormat::OGG}, {".wma", FileFormat::WMA},
+        {".pdf", FileFormat::PDF}, {".docx", FileFormat::DOCX}, {".odt", FileFormat::ODT},
+        {".rtf", FileFormat::RTF},
+    };
+    for (const auto& entry : chain) {
+        if (extension == entry.first) return entry.second;
+    }
+    return FileFormat::UNKNOWN;
+}
+
+template <typename Fn>
+void measure(const std::string& name, const std::vector<std::string>& paths,
+             const std::vector<FileFormat>& truth, Fn detect) {
+    std::size_t correct = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+        if (detect(paths[i]) == truth[i]) {
+            ++correct;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    double nanoseconds = std::chrono::duration<double, std::nano>(end - start).count() / paths.size();
+
+    std::cout << std::left << std::setw(20) << name
+              << std::right << std::setw(10) << std::fixed << std::setprecision(0) << nanoseconds << " ns/file"
+              << std::setw(8) << std::setprecision(1) << (100.0 * correct / paths.size()) << "% correct"
+              << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::size_t fileCount = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 5000;
+    double misnamedShare = (argc > 2) ? std::atof(argv[2]) : 0.2;
+
+    std::vector<Sample> samples = makeSamples();
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<std::size_t> pick(0, samples.size() - 1);
+    std::bernoulli_distribution misnamed(misnamedShare);
+
+    std::vector<std::string> paths;
+    std::vector<FileFormat> truth;
+    for (std::size_t i = 0; i < fileCount; ++i) {
+        const Sample& sample = samples[pick(rng)];
+        const Sample& named = misnamed(rng) ? samples[pick(rng)] : sample;
+
+        std::string path = "bench_detect_" + std::to_string(i) + named.extension;
+        std::ofstream file(path, std::ios::binary);
+        file << sample.header << std::string(8192 - sample.header.size(), 'x');
+        paths.push_back(path);
+        truth.push_back(sample.format);
+    }
+
+    std::cout << fileCount << " files, " << std::setprecision(0) << std::fixed
+              << (misnamedShare * 100) << "% saved under a random extension" << std::endl;
+
+    measure("extension chain", paths, truth, chainedExtension);
+    measure("extension table", paths, truth, converter::formatFromExtension);
+    measure("content sniffing", paths, truth, [](const std::string& path) {
+        return converter::resolveFormat(converter::formatFromExtension(path), converter::sniffFile(path));
+    });
+
+    for (const std::string& path : paths) {
+        std::remove(path.c_str());
+    }
+    return 0;
+}
@@ -0,0 +1,103 @@
+// Per-image latency of the raster conversion engines.
+// Times the in-process Qt path against spawning ImageMagick for PNG to JPG on
+// an icon-sized and a photo-sized image and reports the median wall time of
+// each. ImageMagick is only measured when "magick" is found on PATH; for small
+// images its figure is dominated by process start-up.
+#include "../include/ImageCodec.h"
+#include <QCoreApplication>
+#include <QImage>
+#include <QString>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+namespace {
+
+#ifdef _WIN32
+const char* kNullDevice = "NUL";
+#else
+const char* kNullDevice = "/dev/null";
+#endif
+
+// Smooth gradients with some noise, so the encoders have realistic work to do
+bool writeImage(const std::string& path, int width, int height) {
+    QImage image(width, height, QImage::Format_RGB32);
+    unsigned int seed = 12345;
+    for (int y = 0; y < height; ++y) {
+        QRgb* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        for (int x = 0; x < width; ++x) {
+            seed = seed * 1103515245u + 12345u;
+            int noise = static_cast<int>((seed >> 16) & 15);
+            line[x] = qRgb((x * 255 / width + noise) & 255, (y * 255 / height + noise) & 255, ((x + y) / 4) & 255);
+        }
+    }
+    return image.save(QString::fromStdString(path));
+}
+
+template <typename Fn>
+double medianMilliseconds(int runs, Fn fn) {
+    std::vector<double> times;
+    for (int i = 0; i < runs; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto end = std::chrono::steady_clock::now();
+        times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+void report(const std::string& name, double milliseconds) {
+    std::cout << std::left << std::setw(32) << name
+              << std::right << std::setw(10) << std::fixed << std::setprecision(2) << milliseconds << " ms" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);   // Image plugins are found relative to the executable
+    int runs = (argc > 1) ? std::atoi(argv[1]) : 15;
+
+    if (!converter::qtCanConvertImage(converter::FileFormat::PNG, converter::FileFormat::JPG)) {
+        std::cerr << "Qt's JPEG plugin is not available" << std::endl;
+        return 1;
+    }
+
+    std::string quiet = std::string(" >") + kNullDevice + " 2>" + kNullDevice;
+    bool haveMagick = std::system(("magick -version" + quiet).c_str()) == 0;
+    std::cout << "PNG to JPG, median of " << runs << " runs" << std::endl;
+
+    const struct { const char* name; int width; int height; } sizes[] = {
+        {"64x64", 64, 64},
+        {"1920x1080", 1920, 1080},
+    };
+    const std::string input = "bench_image_input.png";
+    const std::string output = "bench_image_output.jpg";
+
+    for (const auto& size : sizes) {
+        if (!writeImage(input, size.width, size.height)) {
+            std::cerr << "Cannot write " << input << std::endl;
+            return 1;
+        }
+        report(std::string("in-process Qt ") + size.name, medianMilliseconds(runs, [&]() {
+            converter::convertImageFile(input, output, converter::FileFormat::JPG);
+        }));
+        if (haveMagick) {
+            report(std::string("magick convert ") + size.name, medianMilliseconds(runs, [&]() {
+                std::system(("magick convert " + input + " " + output + quiet).c_str());
+            }));
+        }
+    }
+    if (!haveMagick) {
+        std::cout << "magick not found on PATH, external engine not measured" << std::endl;
+    }
+
+    std::remove(input.c_str());
+    std::remove(output.c_str());
+    return 0;
+}
@@ -0,0 +1,92 @@
+// Latency comparison for JSON to TXT engines.
+// Times the in-process streaming renderer against spawning Pandoc on the same
+// document and reports the median wall time of each. Pandoc is only measured
+// when it is found on PATH; its JSON reader expects Pandoc's own AST, so for
+// ordinary JSON it fails after parsing and the figure is its spawn-and-parse
+// cost, a lower bound for any external conversion.
+#include "../include/JsonText.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+namespace {
+
+#ifdef _WIN32
+const char* kNullDevice = "NUL";
+#else
+const char* kNullDevice = "/dev/null";
+#endif
+
+// Array of records similar to a typical API export
+void writeDocument(const std::string& path, std::size_t records) {
+    std::ofstream json(path);
+    json << "[";
+    for (std::size_t i = 0; i < records; ++i) {
+        json << (i ? "," : "") << "\n  {\"id\": " << i
+             << ", \"name\": \"user" << i << "\""
+             << ", \"score\": " << (i * 7919 % 1000) / 10.0
+             << ", \"active\": " << ((i % 3) ? "true" : "false")
+             << ", \"tags\": [\"alpha\", \"beta\"]"
+             << ", \"address\": {\"city\": \"City " << (i % 50) << "\", \"zip\": null}}";
+    }
+    json << "\n]\n";
+}
+
+template <typename Fn>
+double medianMilliseconds(int runs, Fn fn) {
+    std::vector<double> times;
+    for (int i = 0; i < runs; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto end = std::chrono::steady_clock::now();
+        times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+void report(const std::string& name, double milliseconds) {
+    std::cout << std::left << std::setw(28) << name
+              << std::right << std::setw(10) << std::fixed << std::setprecision(2) << milliseconds << " ms" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::size_t records = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 10000;
+    int runs = (argc > 2) ? std::atoi(argv[2]) : 9;
+
+    const std::string input = "bench_json_input.json";
+    const std::string output = "bench_json_output.txt";
+    writeDocument(input, records);
+
+    std::ifstream size(input, std::ios::binary | std::ios::ate);
+    std::cout << records << " records (" << (size.tellg() / 1024) << " KiB), median of "
+              << runs << " runs" << std::endl;
+
+    report("native streaming renderer", medianMilliseconds(runs, [&]() {
+        converter::renderJsonTextFile(input, output);
+    }));
+
+    std::string quiet = std::string(" >") + kNullDevice + " 2>" + kNullDevice;
+    if (std::system(("pandoc --version" + quiet).c_str()) == 0) {
+        report("pandoc process spawn", medianMilliseconds(runs, [&]() {
+            std::system(("pandoc --version" + quiet).c_str());
+        }));
+        report("pandoc -f json -t plain", medianMilliseconds(runs, [&]() {
+            std::system(("pandoc " + input + " -f json -t plain -o " + output + quiet).c_str());
+        }));
+    } else {
+        std::cout << "pandoc not found on PATH, external engine not measured" << std::endl;
+    }
+
+    std::remove(input.c_str());
+    std::remove(output.c_str());
+    return 0;
+}
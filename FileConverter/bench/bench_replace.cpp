@@ -0,0 +1,101 @@
+// Microbenchmark for the delimiter substitution kernels.
+// Compares the old line-by-line std::replace loop against the buffer-wide
+// scalar, SSE2 and AVX2 kernels and reports throughput in GB/s.
+#include "../include/ByteReplace.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Text with words of 1-9 letters separated by spaces and ~80 byte lines
+std::vector<char> makeInput(std::size_t size) {
+    std::vector<char> data(size);
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> wordLength(1, 9);
+    std::size_t lineLength = 0;
+    std::size_t i = 0;
+    while (i < size) {
+        int length = wordLength(rng);
+        for (int j = 0; j < length && i < size; ++j, ++i, ++lineLength) {
+            data[i] = static_cast<char>('a' + (i % 26));
+        }
+        if (i < size) {
+            data[i++] = (lineLength > 80) ? '\n' : ' ';
+            lineLength = (data[i - 1] == '\n') ? 0 : lineLength + 1;
+        }
+    }
+    return data;
+}
+
+template <typename Fn>
+double measure(const std::vector<char>& input, int iterations, Fn fn) {
+    std::vector<char> work(input.size());
+    double best = 0.0;
+    for (int i = 0; i < iterations; ++i) {
+        std::copy(input.begin(), input.end(), work.begin());
+        auto start = std::chrono::steady_clock::now();
+        fn(work);
+        auto end = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(end - start).count();
+        double throughput = static_cast<double>(input.size()) / seconds / 1e9;
+        best = std::max(best, throughput);
+    }
+    return best;
+}
+
+void report(const std::string& name, double gbPerSecond, double baseline) {
+    std::cout << std::left << std::setw(24) << name
+              << std::right << std::setw(8) << std::fixed << std::setprecision(2) << gbPerSecond << " GB/s"
+              << std::setw(8) << std::setprecision(1) << (gbPerSecond / baseline) << "x" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::size_t megabytes = (argc > 1) ? static_cast<std::size_t>(std::atoi(argv[1])) : 256;
+    int iterations = (argc > 2) ? std::atoi(argv[2]) : 5;
+    std::vector<char> input = makeInput(megabytes << 20);
+    
+    std::cout << "Input: " << megabytes << " MiB, best of " << iterations << " runs, CPU kernel: "
+              << converter::simdLevelName(converter::detectSimdLevel()) << std::endl;
+    
+    // The previous converter: getline into a std::string and std::replace per line
+    double lineBased = measure(input, iterations, [](std::vector<char>& work) {
+        std::istringstream stream(std::string(work.begin(), work.end()));
+        std::string line;
+        std::size_t offset = 0;
+        while (std::getline(stream, line)) {
+            std::replace(line.begin(), line.end(), ' ', ',');
+            std::copy(line.begin(), line.end(), work.begin() + static_cast<std::ptrdiff_t>(offset));
+            offset += line.size() + 1;
+        }
+    });
+    report("getline + std::replace", lineBased, lineBased);
+    
+    double wholeBuffer = measure(input, iterations, [](std::vector<char>& work) {
+        std::replace(work.begin(), work.end(), ' ', ',');
+    });
+    report("std::replace (buffer)", wholeBuffer, lineBased);
+    
+    const converter::SimdLevel levels[] = {
+        converter::SimdLevel::SCALAR, converter::SimdLevel::SSE2, converter::SimdLevel::AVX2
+    };
+    for (converter::SimdLevel level : levels) {
+        if (level > converter::detectSimdLevel()) {
+            continue;
+        }
+        double kernel = measure(input, iterations, [level](std::vector<char>& work) {
+            converter::replaceByteWith(level, work.data(), work.size(), ' ', ',');
+        });
+        report(std::string("replaceByte ") + converter::simdLevelName(level), kernel, lineBased);
+    }
+    
+    return 0;
+}
@@ -0,0 +1,116 @@
+// Throughput benchmark for the in-process CSV/JSON/XML converters.
+// Generates a CSV table, converts it around CSV -> JSON -> XML -> CSV and the
+// reverse directions, and reports MB/s of input for each conversion. When
+// Pandoc is on PATH the same pairs are timed through it for comparison; pairs
+// Pandoc cannot produce are reported with its exit status.
+#include "../include/StructuredData.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+namespace {
+
+#ifdef _WIN32
+const char* kNullDevice = "NUL";
+#else
+const char* kNullDevice = "/dev/null";
+#endif
+
+void writeTable(const std::string& path, std::size_t rows) {
+    std::ofstream csv(path, std::ios::binary);
+    csv << "id,name,email,score,comment\n";
+    for (std::size_t i = 0; i < rows; ++i) {
+        csv << i << ",User " << i << ",user" << i << "@example.com," << (i * 7919 % 1000) / 10.0
+            << ",\"said \"\"hello\"\", then left\"\n";
+    }
+}
+
+double fileMegabytes(const std::string& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    return static_cast<double>(file.tellg()) / 1e6;
+}
+
+template <typename Fn>
+double bestSeconds(int runs, Fn fn) {
+    double best = 1e30;
+    for (int i = 0; i < runs; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(end - start).count());
+    }
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::size_t rows = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 200000;
+    int runs = (argc > 2) ? std::atoi(argv[2]) : 3;
+
+    using Function = bool (*)(const std::string&, const std::string&, std::string*);
+    struct Pair {
+        const char* name;
+        const char* input;
+        const char* output;
+        Function function;
+        const char* pandocFrom;
+        const char* pandocTo;
+    };
+    // Each step reads the file the previous one wrote
+    const Pair pairs[] = {
+        {"CSV -> JSON", "bench_data.csv", "bench_data.json", converter::convertCsvToJson, "csv", "json"},
+        {"JSON -> XML", "bench_data.json", "bench_data.xml", converter::convertJsonToXml, "json", "xml"},
+        {"XML -> CSV", "bench_data.xml", "bench_back.csv", converter::convertXmlToCsv, "xml", "csv"},
+        {"CSV -> XML", "bench_data.csv", "bench_csv.xml", converter::convertCsvToXml, "csv", "xml"},
+        {"XML -> JSON", "bench_csv.xml", "bench_xml.json", converter::convertXmlToJson, "xml", "json"},
+        {"JSON -> CSV", "bench_xml.json", "bench_json.csv", converter::convertJsonToCsv, "json", "csv"},
+    };
+
+    writeTable("bench_data.csv", rows);
+    std::cout << rows << " rows (" << std::fixed << std::setprecision(1) << fileMegabytes("bench_data.csv")
+              << " MB CSV), best of " << runs << " runs" << std::endl;
+
+    std::string quiet = std::string(" >") + kNullDevice + " 2>" + kNullDevice;
+    bool pandoc = std::system(("pandoc --version" + quiet).c_str()) == 0;
+
+    for (const Pair& pair : pairs) {
+        std::string error;
+        bool ok = true;
+        double seconds = bestSeconds(runs, [&]() { ok = pair.function(pair.input, pair.output, &error); });
+        double megabytes = fileMegabytes(pair.input);
+
+        std::cout << std::left << std::setw(14) << pair.name << std::right
+                  << std::setw(9) << std::setprecision(1) << (megabytes / seconds) << " MB/s native";
+        if (!ok) {
+            std::cout << " (failed: " << error << ")";
+        }
+
+        if (pandoc) {
+            int status = 0;
+            std::string command = std::string("pandoc ") + pair.input + " -f " + pair.pandocFrom +
+                                  " -t " + pair.pandocTo + " -o bench_pandoc.out" + quiet;
+            double pandocSeconds = bestSeconds(runs, [&]() { status = std::system(command.c_str()); });
+            std::cout << std::setw(9) << (megabytes / pandocSeconds) << " MB/s pandoc";
+            if (status != 0) {
+                std::cout << " (exit status " << status << ")";
+            }
+        }
+        std::cout << std::endl;
+    }
+    if (!pandoc) {
+        std::cout << "pandoc not found on PATH, external route not measured" << std::endl;
+    }
+
+    for (const char* path : {"bench_data.csv", "bench_data.json", "bench_data.xml", "bench_back.csv",
+                             "bench_csv.xml", "bench_xml.json", "bench_json.csv", "bench_pandoc.out"}) {
+        std::remove(path);
+    }
+    return 0;
+}
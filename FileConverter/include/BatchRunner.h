@@ -0,0 +1,51 @@
+#pragma once
+
+#include "FileConverter.h"
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace converter {
+
+// Options for converting many files in one process
+struct BatchOptions {
+    std::string source;         // List file (one path per line), directory or glob pattern
+    std::string outputDir;      // Destination directory; empty writes next to each input
+    FileFormat targetFormat = FileFormat::UNKNOWN;
+    std::size_t jobs = 0;       // Worker threads, 0 for one per hardware thread
+    bool recursive = false;     // Descend into subdirectories when source is a directory
+};
+
+// One conversion of a batch and its outcome
+struct BatchItem {
+    std::string inputFile;
+    std::string outputFile;
+    bool success = false;
+    double seconds = 0.0;
+};
+
+// Runs batches of conversions on a thread pool, sharing a single FileConverter
+class BatchRunner {
+public:
+    explicit BatchRunner(FileConverter& converter);
+    
+    // Expands options.source into conversion items; returns false if the source is invalid.
+    // Inputs whose output path is already taken by an earlier item are skipped.
+    static bool collect(const BatchOptions& options, std::vector<BatchItem>& items);
+    
+    // Item for one input file, with its output placed as collect() would
+    // (relativeDir is mirrored under options.outputDir). Returns false for files
+    // of unknown format or already in the target format.
+    static bool makeItem(const std::string& inputFile, const BatchOptions& options,
+                         const std::string& relativeDir, BatchItem& item);
+    
+    // Converts all items, at most 'jobs' at a time, printing one status line per
+    // file to log. Returns the number of items that did not convert.
+    std::size_t run(std::vector<BatchItem>& items, std::size_t jobs, std::ostream& log);
+    
+private:
+    FileConverter& converter_;
+};
+
+} // namespace converter
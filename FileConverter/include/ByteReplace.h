@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+
+namespace converter {
+
+// Instruction set used by the byte substitution kernel
+enum class SimdLevel {
+    SCALAR,
+    SSE2,
+    AVX2
+};
+
+// Best kernel supported by the running CPU (detected once and cached)
+SimdLevel detectSimdLevel();
+const char* simdLevelName(SimdLevel level);
+
+// Replaces every byte equal to 'from' with 'to' in place, using the fastest
+// kernel available. Blocks without a match are never written back, so pages
+// of a copy-on-write mapping that contain no delimiter stay shared.
+void replaceByte(char* data, std::size_t size, char from, char to);
+
+// Runs a specific kernel; levels the CPU lacks fall back to the best supported one
+void replaceByteWith(SimdLevel level, char* data, std::size_t size, char from, char to);
+
+} // namespace converter
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace converter {
+
+// Incremental XXH64: a fast non-cryptographic 64-bit hash (several GB/s per
+// core), used to key cached conversion results by input content. Not suitable
+// where inputs may be chosen to collide on purpose.
+class ContentHasher {
+public:
+    explicit ContentHasher(std::uint64_t seed = 0);
+    
+    void update(const void* data, std::size_t length);
+    std::uint64_t digest() const;
+    
+private:
+    std::uint64_t accumulators_[4];
+    std::uint64_t seed_;
+    std::uint64_t totalLength_ = 0;
+    unsigned char buffer_[32];
+    std::size_t buffered_ = 0;
+};
+
+// One-shot hash of a buffer
+std::uint64_t hashBytes(const void* data, std::size_t length, std::uint64_t seed = 0);
+
+// Hashes a file's content, memory-mapped when possible, streamed otherwise.
+// Returns false if the file cannot be read.
+bool hashFile(const std::string& path, std::uint64_t& hash);
+
+// 16 lowercase hex digits
+std::string hashToHex(std::uint64_t hash);
+
+} // namespace converter
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace converter {
+
+// On-disk cache of conversion results, keyed by the content hash of the input
+// and a description of how it was converted (formats, engine and tool version).
+// Entries live as files in one directory, so the cache is shared by every
+// process using it. When the total size exceeds the limit, the least recently
+// used entries are removed. The cache is safe to use from several threads.
+class ConversionCache {
+public:
+    struct Stats {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        std::uint64_t stores = 0;
+        std::uint64_t evictions = 0;
+        std::uint64_t bytes = 0;    // Current size of all entries
+        std::size_t entries = 0;
+    };
+
+    // Creates the directory if needed and indexes the entries already in it,
+    // oldest modification time first. Partial entries left by a store that
+    // died more than an hour ago are removed.
+    ConversionCache(const std::string& directory, std::uint64_t maxBytes);
+
+    ConversionCache(const ConversionCache&) = delete;
+    ConversionCache& operator=(const ConversionCache&) = delete;
+
+    bool isValid() const { return valid_; }
+    const std::string& directory() const { return directory_; }
+
+    // Key for converting inputFile to a file with the given extension;
+    // 'parameters' describes everything else the output depends on.
+    // Empty if the input cannot be read.
+    std::string makeKey(const std::string& inputFile, const std::string& extension,
+                        const std::string& parameters) const;
+
+    // Places the cached result for 'key' at outputFile, replacing any file
+    // there. Counts a hit or a miss.
+    bool fetch(const std::string& key, const std::string& outputFile);
+
+    // Adds outputFile as the result for 'key' and evicts old entries as needed.
+    // Results larger than the whole cache are not stored.
+    bool store(const std::string& key, const std::string& outputFile);
+
+    // Outputs are materialised as a reflink (copy-on-write clone) where the file
+    // system supports it and as a copy otherwise. With hard links allowed, fetch
+    // tries a hard link before copying: it costs no space, but the output then
+    // shares its data with the cache entry and must not be modified in place.
+    // store always reflinks or copies.
+    void setHardLinks(bool allowed) { hardLinks_ = allowed; }
+
+    Stats stats() const;
+
+private:
+    struct Entry {
+        std::string path;
+        std::uint64_t size = 0;
+        std::list<std::string>::iterator position;  // In recency_
+    };
+
+    bool materialise(const std::string& source, const std::string& target, bool allowHardLink) const;
+    void evictLocked();
+
+    std::string directory_;
+    std::uint64_t maxBytes_;
+    bool valid_ = false;
+    std::atomic<bool> hardLinks_{false};
+
+    mutable std::mutex mutex_;
+    std::map<std::string, Entry> entries_;
+    std::list<std::string> recency_;   // Keys, least recently used first
+    std::uint64_t totalBytes_ = 0;
+
+    std::atomic<std::uint64_t> hits_{0};
+    std::atomic<std::uint64_t> misses_{0};
+    std::atomic<std::uint64_t> stores_{0};
+    std::atomic<std::uint64_t> evictions_{0};
+};
+
+} // namespace converter
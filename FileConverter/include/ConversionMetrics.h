@@ -0,0 +1,111 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <tuple>
+
+namespace converter {
+
+// Stages a conversion's wall time is split into
+enum class Phase {
+    PROBE,      // Format detection, tool lookup and cache key hashing
+    WAIT,       // Waiting for a share of the CPU budget
+    SPAWN,      // Starting external tools
+    RUN,        // External tools running, or the in-process converter
+    RENAME      // Moving outputs into place and cache copies
+};
+
+constexpr std::size_t kPhaseCount = static_cast<std::size_t>(Phase::RENAME) + 1;
+
+// Why a conversion failed; the first cause noticed is kept
+enum class FailureReason {
+    NONE,
+    UNSUPPORTED,        // Unknown format or no route
+    TOOL_MISSING,       // External tool not installed
+    START_FAILED,       // Tool could not be started
+    CRASHED,            // Tool terminated abnormally
+    EXIT_CODE,          // Tool exited with a non-zero code
+    NO_OUTPUT,          // Tool finished but the output was not produced
+    CANCELLED,
+    CONVERTER_ERROR     // In-process converter failed
+};
+
+// Everything measured about one conversion
+struct ConversionRecord {
+    std::string from;       // Input extension without the dot, e.g. "png"
+    std::string to;
+    std::string engine;     // "native", a backend name, or "cache" for cache hits
+    bool success = false;
+    FailureReason failure = FailureReason::NONE;
+    std::array<double, kPhaseCount> seconds{};      // Time spent in each phase
+    std::array<bool, kPhaseCount> entered{};        // Phases the conversion went through
+    std::uint64_t bytesIn = 0;
+    std::uint64_t bytesOut = 0;
+
+    void addTime(Phase phase, double elapsed);
+    double totalSeconds() const;
+};
+
+// Latency histogram with fixed buckets from 1 ms to 10 minutes
+class LatencyHistogram {
+public:
+    // Upper bounds of the buckets in seconds; a final bucket catches the rest
+    static constexpr std::size_t kBucketCount = 12;
+    static const std::array<double, kBucketCount>& bounds();
+
+    void add(double seconds);
+
+    std::uint64_t count() const { return count_; }
+    double sum() const { return sum_; }
+    // Observations per bucket (not cumulative); index kBucketCount is the overflow
+    const std::array<std::uint64_t, kBucketCount + 1>& buckets() const { return buckets_; }
+
+private:
+    std::array<std::uint64_t, kBucketCount + 1> buckets_{};
+    std::uint64_t count_ = 0;
+    double sum_ = 0.0;
+};
+
+// Totals of one route (input format, output format, engine)
+struct RouteMetrics {
+    std::uint64_t conversions = 0;
+    std::uint64_t failures = 0;
+    std::uint64_t bytesIn = 0;
+    std::uint64_t bytesOut = 0;
+    std::map<FailureReason, std::uint64_t> failureReasons;
+    LatencyHistogram total;
+    std::array<LatencyHistogram, kPhaseCount> phases;
+};
+
+// Thread-safe aggregate of conversion records, exportable as JSON lines (one
+// object per route) or in the Prometheus text exposition format
+class ConversionMetrics {
+public:
+    using RouteKey = std::tuple<std::string, std::string, std::string>;   // from, to, engine
+
+    void record(const ConversionRecord& record);
+    void reset();
+    std::map<RouteKey, RouteMetrics> snapshot() const;
+    // Totals of one route, all zero if it has not been used
+    RouteMetrics route(const RouteKey& key) const;
+
+    void writeJsonLines(std::ostream& out) const;
+    void writePrometheus(std::ostream& out) const;
+    // Writes the Prometheus format for paths ending in ".prom", JSON lines
+    // otherwise. The file is replaced atomically so scrapers never see half of it.
+    bool writeFile(const std::string& path) const;
+
+    static const char* phaseName(Phase phase);
+    static const char* failureName(FailureReason reason);
+
+private:
+    mutable std::mutex mutex_;
+    std::map<RouteKey, RouteMetrics> routes_;
+};
+
+} // namespace converter
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+namespace converter {
+
+// Progress of a running conversion, as reported by tools that support it (FFmpeg)
+struct ConversionProgress {
+    double percent = -1.0;          // 0-100, or -1 while the total duration is unknown
+    double processedSeconds = 0.0;  // Media time written so far
+    double totalSeconds = 0.0;      // Media duration, 0 if unknown
+    double fps = 0.0;               // Frames encoded per second
+    double speed = 0.0;             // Encoding speed as a multiple of real time
+    double etaSeconds = -1.0;       // Estimated time remaining, -1 if unknown
+    bool finished = false;
+};
+
+// Invoked on the thread running the conversion
+using ProgressCallback = std::function<void(const ConversionProgress&)>;
+
+// Incremental parser for FFmpeg's machine-readable "-progress" output.
+// Feed stdout (key=value blocks) and stderr (the banner, which carries the
+// input duration) in whatever chunks they arrive.
+class FfmpegProgressParser {
+public:
+    // Banner/log output on stderr; extracts "Duration: HH:MM:SS.xx"
+    void feedLog(const char* data, std::size_t size);
+    
+    // "-progress" output; returns true if at least one progress block completed
+    bool feedProgress(const char* data, std::size_t size);
+    
+    const ConversionProgress& current() const { return progress_; }
+    
+    // Parses "HH:MM:SS.xx" into seconds, -1 if malformed
+    static double parseTimestamp(const std::string& text);
+    
+private:
+    void handleLogLine(const std::string& line);
+    bool handleProgressLine(const std::string& line);
+    
+    std::string logBuffer_;
+    std::string progressBuffer_;
+    ConversionProgress progress_;
+};
+
+} // namespace converter
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace converter {
+
+// Streaming RFC 4180 record reader. Fields may be quoted; inside quotes a
+// doubled quote stands for one quote and delimiters and line breaks are part
+// of the field. Records end at LF or CRLF; blank lines are skipped. Input is
+// read in 64 KiB blocks and only the current record is held in memory.
+class CsvReader {
+public:
+    explicit CsvReader(std::istream& input, char delimiter = ',');
+
+    // Reads the next record into 'fields'. Returns false at the end of the
+    // input or on malformed quoting (then error() is set).
+    bool next(std::vector<std::string>& fields);
+
+    const std::string& error() const { return error_; }
+
+    // 1-based number of the record returned last
+    std::size_t recordNumber() const { return records_; }
+
+private:
+    int peek();
+    int get();
+
+    std::istream& input_;
+    char delimiter_;
+    std::vector<char> buffer_;
+    std::size_t pos_ = 0;
+    std::size_t end_ = 0;
+    std::size_t records_ = 0;
+    std::string error_;
+};
+
+// Appends 'field' to 'out', quoted when it contains the delimiter, a quote or
+// a line break
+void appendCsvField(std::string& out, const std::string& field, char delimiter = ',');
+
+// Appends a whole record followed by a newline
+void appendCsvRecord(std::string& out, const std::vector<std::string>& fields, char delimiter = ',');
+
+} // namespace converter
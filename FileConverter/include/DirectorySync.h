@@ -0,0 +1,66 @@
+#pragma once
+
+#include "FileConverter.h"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+
+namespace converter {
+
+// What a sync run recorded about one input, keyed by its path relative to the source
+struct SyncRecord {
+    std::string outputFile;     // Relative to the output directory
+    std::uint64_t size = 0;
+    std::int64_t modified = 0;  // Modification time, ms since the epoch
+    std::uint64_t hash = 0;     // XXH64 of the content
+};
+
+// State of a mirrored tree between runs, stored as one line per input:
+//   <size> <mtime ms> <hash hex> <input>\t<output>
+// after a header naming the target extension. Saved atomically (written to a
+// temporary file, then renamed over the old one).
+class SyncManifest {
+public:
+    // A missing manifest loads as empty; false only for an unreadable or malformed one
+    bool load(const std::string& path);
+    bool save(const std::string& path) const;
+
+    std::string targetExtension;
+    std::map<std::string, SyncRecord> records;
+};
+
+struct SyncOptions {
+    std::string sourceDir;
+    std::string outputDir;
+    FileFormat targetFormat = FileFormat::UNKNOWN;
+    std::size_t jobs = 0;       // Worker threads, 0 for one per hardware thread
+    std::string manifestPath;   // Empty: ".fileconverter-sync" in outputDir
+};
+
+struct SyncSummary {
+    std::size_t converted = 0;
+    std::size_t unchanged = 0;
+    std::size_t deleted = 0;    // Stale outputs removed
+    std::size_t failed = 0;
+};
+
+// Mirrors a source tree into outputDir in the target format, converting only
+// inputs that are new or changed since the last run. Unchanged size and mtime
+// skip a file without reading it; otherwise its content hash decides, so a
+// touched but identical file is not reconverted. Outputs whose input was
+// removed (or that were produced for another target format) are deleted.
+// Failed conversions are left out of the manifest and retried next run.
+class DirectorySync {
+public:
+    explicit DirectorySync(FileConverter& converter);
+
+    // Returns false if the source, output directory or manifest is unusable
+    bool run(const SyncOptions& options, std::ostream& log, SyncSummary& summary);
+
+private:
+    FileConverter& converter_;
+};
+
+} // namespace converter
@@ -4,54 +4,48 @@
 #include <vector>
 #include <map>
 #include <memory>
+#include <atomic>
+#include <functional>
+#include <mutex>
+
+#include "FormatTable.h"
+#include "ToolRegistry.h"
+#include "ConversionProgress.h"
+#include "ConversionCache.h"
+#include "ResourceScheduler.h"
+#include "ConversionMetrics.h"
 
 // Add Qt includes
 #include <QString>
-#include <QJsonObject>
-#include <QJsonArray>
-#include <QJsonValue>
-#include <QTextStream>
+#include <QStringList>
+
+class QProcess;
 
 namespace converter {
 
-enum class FileFormat {
-    UNKNOWN,
-    TXT,
-    CSV,
-    JSON,
-    XML,
-    HTML,
-    MD,
-    // Image formats
-    JPG,
-    PNG,
-    GIF,
-    BMP,
-    TIFF,
-    WEBP,
-    SVG,
-    ICO,
-    // Video formats
-    MP4,
-    AVI,
-    MOV,
-    MKV,
-    WMV,
-    FLV,
-    WEBM,
-    M4V,
-    // Audio formats
-    MP3,
-    WAV,
-    AAC,
-    FLAC,
-    OGG,
-    WMA,
-    // Document formats
-    PDF,
-    DOCX,
-    ODT,
-    RTF
+class OfficeWorkerPool;
+
+// One input/output pair of a batch conversion
+struct ConversionJob {
+    std::string inputFile;
+    std::string outputFile;
+};
+
+// Engine choice for format pairs served both in-process and by an external tool
+enum class Engine {
+    NATIVE,    // Registered FormatConverter
+    EXTERNAL   // Tool from the route table (Pandoc, ImageMagick, ...)
+};
+
+// How a conversion would run, as reported by FileConverter::explain()
+struct RoutePlan {
+    Backend engine = Backend::NONE;     // NATIVE, an external backend, or NONE if unsupported
+    bool available = false;             // The engine can run (its tool is installed)
+    std::string reason;                 // Why this engine was picked
+    CostClass cost = CostClass::LIGHT;
+    std::size_t threads = 0;            // Thread budget under setCpuBudget(), 0 = tool default
+    std::size_t processes = 0;          // External processes started per conversion
+    double expectedSeconds = -1.0;      // Mean of the route's earlier conversions, -1 if none yet
 };
 
 // Abstract base class for format converters
@@ -59,6 +53,16 @@ class FormatConverter {
 public:
     virtual ~FormatConverter() = default;
     virtual bool convert(const std::string& inputFile, const std::string& outputFile) = 0;
+    // What FileConverter calls, with the thread budget of the conversion (0 = no
+    // limit, see setCpuBudget()); converters that run several threads override it
+    virtual bool convertWithThreads(const std::string& inputFile, const std::string& outputFile,
+                                    std::size_t threads) {
+        (void)threads;
+        return convert(inputFile, outputFile);
+    }
+    // Whether this particular input can be converted; inputs it declines go to
+    // the external tool of the route when that is installed
+    virtual bool accepts(const std::string& inputFile) const { (void)inputFile; return true; }
 };
 
 class FileConverter {
@@ -69,22 +73,177 @@ public:
     // Main conversion method
     bool convert(const std::string& inputFile, const std::string& outputFile);
     
+    // Converts many office documents (PDF, DOCX, ODT, RTF), starting one soffice
+    // run per target format instead of one per file. Other jobs, and documents
+    // the batched run fails to produce, are converted individually.
+    // Returns one success flag per job, in order.
+    std::vector<bool> convertDocuments(const std::vector<ConversionJob>& jobs);
+    
+    // Converts many raster images as a pipeline: this thread reads inputs ahead
+    // while 'threads' workers (0 for one per hardware thread) decode, flatten,
+    // encode and write them, each reusing its pixel and output buffers from one
+    // image to the next. At most about twice 'threads' inputs are in memory at
+    // once however long the batch is. Jobs the in-process engine does not take
+    // (other formats, inputs it declines or over 2 GiB, EXTERNAL preference) run through
+    // convert() on the same workers, except those routed to ImageMagick: these
+    // are grouped by target format and converted many per "magick mogrify" run,
+    // and the images a run fails to produce are retried one at a time.
+    // onFinished, if set, is called as each job completes, from a worker thread
+    // but never concurrently.
+    // Returns one success flag per job, in order.
+    using ImageCallback = std::function<void(std::size_t index, bool success, double seconds)>;
+    std::vector<bool> convertImages(const std::vector<ConversionJob>& jobs, std::size_t threads = 0,
+                                    const ImageCallback& onFinished = nullptr);
+    
     // Format detection and utilities
     static FileFormat detectFormat(const std::string& filePath);
+    // Format of an existing file: its leading bytes, with the extension as fallback
+    static FileFormat detectInputFormat(const std::string& filePath);
     static std::string getExtension(FileFormat format);
+    // Formats with at least one conversion route, in enum order
     std::vector<FileFormat> getSupportedFormats() const;
+    // Formats the given input can be converted to, in enum order
+    std::vector<FileFormat> getSupportedOutputFormats(FileFormat inputFormat) const;
+    
+    // Per-pair engine preference. Only matters for pairs with a native converter,
+    // which is preferred by default: it runs in-process without spawning a tool.
+    // EXTERNAL hands the pair to its tool instead; the native converter is still
+    // used when that tool is missing. Call before starting conversions.
+    void setEnginePreference(FileFormat inputFormat, FileFormat outputFormat, Engine engine);
+    Engine enginePreference(FileFormat inputFormat, FileFormat outputFormat) const;
+    bool hasNativeConverter(FileFormat inputFormat, FileFormat outputFormat) const;
+    
+    // Dry run: the engine convert() would use for the pair and what it is
+    // expected to cost, without converting anything. The file overload detects
+    // the input format from the file's content as convert() does.
+    RoutePlan explain(FileFormat inputFormat, FileFormat outputFormat) const;
+    RoutePlan explain(const std::string& inputFile, const std::string& outputFile) const;
+    
+    // External tool discovery (probed once per process and cached)
+    ToolInfo getToolInfo(const std::string& tool) const;
+    bool isToolAvailable(const std::string& tool) const;
+    
+    // Cancellation (thread-safe): kills the external tool of any running conversion
+    // and makes it fail. Stays in effect until resetCancel() is called.
+    void cancel();
+    void resetCancel();
+    bool isCancelled() const;
+    
+    // Progress reporting for tools that support it (FFmpeg). The callback runs on
+    // the converting thread; set it before starting conversions.
+    void setProgressCallback(ProgressCallback callback);
+    
+    // Number of persistent LibreOffice instances reused for document conversions,
+    // started on first use and shut down with the converter. 0 (the default)
+    // starts a fresh soffice per document, which leaves nothing running should
+    // the process be killed; long batch runs are where the pool pays off.
+    // Call before starting conversions.
+    void setOfficeWorkers(std::size_t count);
+    std::size_t officeWorkers() const;
+    
+    // Reuses earlier results for inputs with identical content converted the same
+    // way (same output format, engine and tool version), from an on-disk cache in
+    // 'directory' holding at most maxBytes. See ConversionCache for how hits are
+    // materialised. An empty directory turns the cache off (the default).
+    // Returns false if the directory cannot be created. Call before starting conversions.
+    bool setCache(const std::string& directory, std::uint64_t maxBytes, bool hardLinks = false);
+    ConversionCache::Stats cacheStats() const;
+    
+    // Caps the cores used by concurrent conversions at 'cores' (see
+    // ResourceScheduler): each conversion waits for its share and passes it to the
+    // tool as a thread limit. 0 turns the budget off (the default), leaving every
+    // tool to size its own thread pool. Call before starting conversions.
+    void setCpuBudget(std::size_t cores);
+    std::size_t cpuBudget() const;
+    
+    // Per-route counters and phase latencies of every conversion so far
+    // (probe, CPU budget wait, tool spawn, tool runtime, rename), bytes in and
+    // out and failures by reason. Cache hits are counted under engine "cache".
+    ConversionMetrics& metrics() { return metrics_; }
+    const ConversionMetrics& metrics() const { return metrics_; }
     
 private:
     void initConverters();
     
-    // JSON to TXT conversion methods
-    bool convertJsonToTxt(const std::string& inputPath, const std::string& outputPath);
-    void convertJsonObjectToText(const QJsonObject& obj, QTextStream& out, int indent);
-    void convertJsonArrayToText(const QJsonArray& arr, QTextStream& out, int indent);
-    QString valueToString(const QJsonValue& value);
+    // Body of convert(), filling in the measurements of the active record
+    bool runConversion(const std::string& inputFile, const std::string& outputFile, ConversionRecord& record);
+    
+    // Whether the pair runs in-process: a native converter is registered and it is
+    // preferred (and accepts inputFile, unless that is empty), no tool serves the
+    // pair, or the tool is not installed
+    bool usesNativeConverter(FileFormat inputFormat, FileFormat outputFormat, Backend backend,
+                             const std::string& inputFile = std::string()) const;
+    // explain() for a pair, and for a given input when inputFile is not empty
+    RoutePlan planRoute(FileFormat inputFormat, FileFormat outputFormat, const std::string& inputFile) const;
+    // What a result depends on besides the input content, as part of its cache key
+    std::string cacheParameters(FileFormat inputFormat, FileFormat outputFormat, Backend backend, bool native) const;
+    // Cache key of a conversion; empty without a cache or if the input cannot be read
+    std::string cacheKeyFor(const std::string& inputFile, FileFormat inputFormat, FileFormat outputFormat,
+                            Backend backend, bool native) const;
+    // Places the cached result for cacheKey at outputFile. On a miss any file there
+    // is removed, since it may be a hard link to a cache entry.
+    bool fetchCached(const std::string& cacheKey, const std::string& outputFile);
+    void storeCached(const std::string& cacheKey, const std::string& outputFile);
+    // Waits for a share of the CPU budget; null without a scheduler
+    std::unique_ptr<ResourceScheduler::Lease> acquireLease(CostClass cost);
+    // Completes 'record' with the outcome and sizes and adds it to the metrics
+    void finishRecord(ConversionRecord& record, const std::string& inputFile, const std::string& outputFile,
+                      bool success);
+    // Runs the external tool of the route; threads 0 leaves the thread count to the tool
+    bool convertWithBackend(Backend backend, const std::string& inputFile, const std::string& outputFile,
+                            FileFormat inputFormat, FileFormat outputFormat, std::size_t threads);
+    
+    // Runs an external tool to completion, killing it if cancel() is requested.
+    // onPoll is called periodically (and once at exit) to consume output.
+    // Returns false if the tool could not start, crashed or was cancelled.
+    bool runProcess(QProcess& process, const QString& program, const QStringList& args,
+                    const std::function<void()>& onPoll = nullptr);
+    
+    // Text conversion through Pandoc
+    bool convertWithPandoc(const std::string& inputFile, const std::string& outputFile,
+                           FileFormat inputFormat, FileFormat outputFormat);
+    
+    // Image conversion through ImageMagick
+    bool convertWithImageMagick(const std::string& inputFile, const std::string& outputFile,
+                                std::size_t threads);
+    
+    // Audio/video conversion through FFmpeg with progress reporting. With
+    // streamCopy the encoded streams are copied into the new container as they are.
+    bool convertWithFfmpeg(const std::string& inputFile, const std::string& outputFile, std::size_t threads,
+                           bool streamCopy = false);
+    // Whether converting inputFile to outputFormat is a container change only,
+    // judged from its streams as reported by ffprobe; 'reason' says why not
+    bool probeStreamCopy(const std::string& inputFile, FileFormat inputFormat, FileFormat outputFormat,
+                         std::string* reason = nullptr) const;
+    
+    // Document conversion through LibreOffice, using the worker pool when enabled
+    bool convertWithLibreOffice(const std::string& inputFile, const std::string& outputFile,
+                                FileFormat inputFormat, FileFormat outputFormat);
+    OfficeWorkerPool* officePool(const std::string& sofficePath);
+    void runOfficeBatch(const ToolInfo& soffice, const std::vector<ConversionJob>& jobs,
+                        const std::vector<std::size_t>& run, FileFormat outputFormat,
+                        bool pdfImport, std::vector<bool>& results, std::vector<ConversionRecord>& records);
+    // One mogrify run over the images of 'run'; produced[k] and records[k]
+    // belong to run[k]
+    void runMagickBatch(const ToolInfo& magick, const std::vector<ConversionJob>& jobs,
+                        const std::vector<std::size_t>& run, FileFormat outputFormat,
+                        std::vector<bool>& produced, std::vector<ConversionRecord>& records);
     
     // Map to store converters for different format pairs
     std::map<std::pair<FileFormat, FileFormat>, std::unique_ptr<FormatConverter>> converters_;
+    // Engine preferences set explicitly; other pairs use the defaults
+    std::map<std::pair<FileFormat, FileFormat>, Engine> enginePreferences_;
+    
+    std::atomic<bool> cancelled_{false};
+    ProgressCallback progressCallback_;
+    
+    mutable std::mutex officePoolMutex_;
+    std::size_t officeWorkerCount_ = 0;
+    std::unique_ptr<OfficeWorkerPool> officePool_;
+    
+    std::unique_ptr<ConversionCache> cache_;
+    std::unique_ptr<ResourceScheduler> scheduler_;
+    ConversionMetrics metrics_;
 };
 
 } // namespace converter
\ No newline at end of file
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace converter {
+
+struct WatchOptions {
+    std::string directory;
+    bool recursive = false;     // Also watch subdirectories, including ones created later
+    int settleMs = 250;         // Quiet time after the last write before a file is reported
+};
+
+// Reports files dropped into a directory once they are complete. On Linux this
+// uses inotify: a file becomes a candidate when its writer closes it (or it is
+// moved in) and is reported after settleMs without further writes, so tools that
+// reopen a file to append are not caught halfway. Other platforms poll the
+// directory and report a file once its size and mtime stay unchanged for settleMs.
+//
+// A reported file is in progress until finished() is called for it. If it
+// settles again meanwhile (rewritten while being converted), it is not reported
+// a second time right away but once more after finished().
+class FolderWatcher {
+public:
+    using ReadyCallback = std::function<void(const std::string& path)>;
+
+    explicit FolderWatcher(WatchOptions options);
+    ~FolderWatcher();
+
+    FolderWatcher(const FolderWatcher&) = delete;
+    FolderWatcher& operator=(const FolderWatcher&) = delete;
+
+    // Sets up the watches; false if the directory cannot be watched
+    bool start();
+
+    // Calls onReady for each completed file until stop() is called. While the
+    // callback blocks (e.g. on a full work queue) new events wait in the kernel
+    // queue; if that overflows, the directories are rescanned for files changed
+    // since watching began.
+    void run(const ReadyCallback& onReady);
+
+    // Makes run() return; safe to call from another thread or a signal handler
+    void stop();
+
+    // Marks a file as in progress without it having been reported, e.g. one
+    // already present that is converted on start. Safe to call from any thread.
+    void claim(const std::string& path);
+    // Ends the in-progress state of a file and reports it again if it settled
+    // once more in the meantime. Safe to call from any thread.
+    void finished(const std::string& path);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void markPending(const std::string& path);
+    void dispatchDue(const ReadyCallback& onReady);
+    int msUntilNextDeadline() const;
+    // Moves the files finished() queued for another report into pending_
+    void takeRequeued();
+    // Interrupts a run() waiting for events
+    void wake();
+
+    WatchOptions options_;
+    std::atomic<bool> stopping_{false};
+    std::map<std::string, Clock::time_point> pending_;  // Path -> time it is due
+    long long startedAtMs_ = 0;                         // Wall clock, for rescans
+
+    std::mutex progressMutex_;
+    std::set<std::string> inProgress_;          // Reported or claimed, not finished yet
+    std::set<std::string> changedInProgress_;   // Settled again while in progress
+    std::vector<std::string> requeued_;         // Finished after changing, to report again
+
+#ifdef __linux__
+    bool addWatch(const std::string& directory);
+    void readEvents();
+    // Marks the files below 'directory' modified at or after modifiedSinceMs
+    void scanDirectory(const std::string& directory, long long modifiedSinceMs);
+
+    int inotifyFd_ = -1;
+    int wakeFds_[2] = {-1, -1};     // Self-pipe that interrupts poll() on stop()
+    std::map<int, std::string> watches_;
+#else
+    void pollDirectory();
+
+    // Size and mtime of every file at the last poll
+    std::map<std::string, std::pair<long long, long long>> seen_;
+#endif
+};
+
+} // namespace converter
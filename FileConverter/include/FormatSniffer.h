@@ -0,0 +1,46 @@
+#pragma once
+
+#include "FormatTable.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace converter {
+
+// Bytes read from the start of a file for content detection
+constexpr std::size_t kSniffSize = 4096;
+
+// Set of FileFormat values, one bit per format
+using FormatMask = std::uint64_t;
+
+static_assert(kFormatCount <= 64, "FormatMask needs one bit per FileFormat");
+
+constexpr FormatMask formatBit(FileFormat format) {
+    return FormatMask(1) << formatIndex(format);
+}
+
+// Result of inspecting a file's leading bytes. Several formats share a
+// container (DOCX and ODT are ZIP, MP4/MOV/M4V are ISO media, WMV/WMA are
+// ASF), so a match names the most likely format plus every format the bytes
+// are compatible with.
+struct SniffResult {
+    FileFormat format = FileFormat::UNKNOWN;
+    FormatMask compatible = 0;
+};
+
+// Format implied by the file name's extension (case-insensitive)
+FileFormat formatFromExtension(const std::string& filename);
+
+// Content detection over an in-memory prefix of a file
+SniffResult sniffFormat(const unsigned char* data, std::size_t size);
+
+// Reads at most kSniffSize bytes of the file and sniffs them
+SniffResult sniffFile(const std::string& filePath);
+
+// Combines both sources: the extension is kept while the content agrees with
+// it, the content wins when the extension is unknown or names a format the
+// bytes cannot be.
+FileFormat resolveFormat(FileFormat fromExtension, const SniffResult& sniffed);
+
+} // namespace converter
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+namespace converter {
+
+enum class FileFormat {
+    UNKNOWN,
+    TXT,
+    CSV,
+    JSON,
+    XML,
+    HTML,
+    MD,
+    // Image formats
+    JPG,
+    PNG,
+    GIF,
+    BMP,
+    TIFF,
+    WEBP,
+    SVG,
+    ICO,
+    // Video formats
+    MP4,
+    AVI,
+    MOV,
+    MKV,
+    WMV,
+    FLV,
+    WEBM,
+    M4V,
+    // Audio formats
+    MP3,
+    WAV,
+    AAC,
+    FLAC,
+    OGG,
+    WMA,
+    // Document formats
+    PDF,
+    DOCX,
+    ODT,
+    RTF
+};
+
+// Number of FileFormat values, UNKNOWN included
+constexpr std::size_t kFormatCount = static_cast<std::size_t>(FileFormat::RTF) + 1;
+
+constexpr std::size_t formatIndex(FileFormat format) {
+    return static_cast<std::size_t>(format);
+}
+
+// Family a format belongs to; conversions stay within a family
+enum class FormatCategory {
+    NONE,
+    TEXT,
+    IMAGE,
+    VIDEO,
+    AUDIO,
+    DOCUMENT
+};
+
+// Engine that performs a conversion
+enum class Backend {
+    NONE,
+    NATIVE,       // In-process FormatConverter
+    PANDOC,
+    IMAGEMAGICK,
+    FFMPEG,
+    LIBREOFFICE
+};
+
+// Category of every format, indexed by FileFormat
+constexpr FormatCategory kFormatCategories[kFormatCount] = {
+    FormatCategory::NONE,       // UNKNOWN
+    // Text formats
+    FormatCategory::TEXT,       // TXT
+    FormatCategory::TEXT,       // CSV
+    FormatCategory::TEXT,       // JSON
+    FormatCategory::TEXT,       // XML
+    FormatCategory::TEXT,       // HTML
+    FormatCategory::TEXT,       // MD
+    // Image formats
+    FormatCategory::IMAGE,      // JPG
+    FormatCategory::IMAGE,      // PNG
+    FormatCategory::IMAGE,      // GIF
+    FormatCategory::IMAGE,      // BMP
+    FormatCategory::IMAGE,      // TIFF
+    FormatCategory::IMAGE,      // WEBP
+    FormatCategory::IMAGE,      // SVG
+    FormatCategory::IMAGE,      // ICO
+    // Video formats
+    FormatCategory::VIDEO,      // MP4
+    FormatCategory::VIDEO,      // AVI
+    FormatCategory::VIDEO,      // MOV
+    FormatCategory::VIDEO,      // MKV
+    FormatCategory::VIDEO,      // WMV
+    FormatCategory::VIDEO,      // FLV
+    FormatCategory::VIDEO,      // WEBM
+    FormatCategory::VIDEO,      // M4V
+    // Audio formats
+    FormatCategory::AUDIO,      // MP3
+    FormatCategory::AUDIO,      // WAV
+    FormatCategory::AUDIO,      // AAC
+    FormatCategory::AUDIO,      // FLAC
+    FormatCategory::AUDIO,      // OGG
+    FormatCategory::AUDIO,      // WMA
+    // Document formats
+    FormatCategory::DOCUMENT,   // PDF
+    FormatCategory::DOCUMENT,   // DOCX
+    FormatCategory::DOCUMENT,   // ODT
+    FormatCategory::DOCUMENT    // RTF
+};
+
+constexpr FormatCategory categoryOf(FileFormat format) {
+    return kFormatCategories[formatIndex(format)];
+}
+
+// External tool serving each category
+constexpr Backend categoryBackend(FormatCategory category) {
+    switch (category) {
+        case FormatCategory::TEXT: return Backend::PANDOC;
+        case FormatCategory::IMAGE: return Backend::IMAGEMAGICK;
+        case FormatCategory::VIDEO: return Backend::FFMPEG;
+        case FormatCategory::AUDIO: return Backend::FFMPEG;
+        case FormatCategory::DOCUMENT: return Backend::LIBREOFFICE;
+        default: return Backend::NONE;
+    }
+}
+
+using RouteTable = std::array<std::array<Backend, kFormatCount>, kFormatCount>;
+
+// Conversion routes, indexed [input][output]. This is the single place where
+// backends are assigned to format pairs.
+constexpr RouteTable buildRouteTable() {
+    RouteTable table{};
+    for (std::size_t in = 0; in < kFormatCount; ++in) {
+        for (std::size_t out = 0; out < kFormatCount; ++out) {
+            FormatCategory inCategory = kFormatCategories[in];
+            table[in][out] = (inCategory == kFormatCategories[out]) ? categoryBackend(inCategory) : Backend::NONE;
+        }
+    }
+    return table;
+}
+
+constexpr RouteTable kRouteTable = buildRouteTable();
+
+constexpr Backend routeFor(FileFormat input, FileFormat output) {
+    return kRouteTable[formatIndex(input)][formatIndex(output)];
+}
+
+// Executable behind an external backend, nullptr for NATIVE/NONE
+constexpr const char* backendTool(Backend backend) {
+    switch (backend) {
+        case Backend::PANDOC: return "pandoc";
+        case Backend::IMAGEMAGICK: return "magick";
+        case Backend::FFMPEG: return "ffmpeg";
+        case Backend::LIBREOFFICE: return "soffice";
+        default: return nullptr;
+    }
+}
+
+constexpr const char* backendName(Backend backend) {
+    switch (backend) {
+        case Backend::NATIVE: return "native";
+        case Backend::PANDOC: return "Pandoc";
+        case Backend::IMAGEMAGICK: return "ImageMagick";
+        case Backend::FFMPEG: return "FFmpeg";
+        case Backend::LIBREOFFICE: return "LibreOffice";
+        default: return "none";
+    }
+}
+
+// A format added to the enum but not to kFormatCategories shifts RTF onto NONE
+static_assert(categoryOf(FileFormat::RTF) == FormatCategory::DOCUMENT,
+              "kFormatCategories must list every FileFormat in enum order");
+static_assert(routeFor(FileFormat::PNG, FileFormat::JPG) == Backend::IMAGEMAGICK, "image route");
+static_assert(routeFor(FileFormat::MP3, FileFormat::MP4) == Backend::NONE, "no cross-category route");
+
+} // namespace converter
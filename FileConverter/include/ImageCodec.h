@@ -0,0 +1,46 @@
+#pragma once
+
+#include "FormatTable.h"
+#include <QByteArray>
+#include <QImage>
+#include <string>
+
+namespace converter {
+
+// Raster image conversion through Qt's image plugins (QImageReader and
+// QImageWriter), in-process instead of starting ImageMagick for every file.
+// SVG is left to ImageMagick, as are the formats whose Qt plugin is not
+// installed (WEBP, TIFF and ICO come from the optional qtimageformats module).
+
+// Whether Qt can read 'input' and write 'output'
+bool qtCanConvertImage(FileFormat input, FileFormat output);
+
+// Whether the in-process path produces what ImageMagick would for this file:
+// a single-frame image Qt can decode, and for ICO output at most 256x256.
+// Only the header is read.
+bool qtAcceptsImage(const std::string& inputFile, FileFormat output);
+
+// Working memory of one image worker. Kept across images, the pixel and output
+// buffers are reused whenever the next image has the same size and format, so a
+// batch of similar images stops allocating after the first few.
+struct ImageBuffers {
+    QImage decoded;         // QImageReader decodes into it in place when it fits
+    QImage flattened;       // Alpha composited onto white
+    QByteArray encoded;     // Output file contents
+};
+
+// Converts an encoded image held in memory; the result is left in buffers.encoded
+bool convertImageData(const QByteArray& input, FileFormat output, ImageBuffers& buffers,
+                      std::string* error = nullptr);
+
+// Writes an encoded image to outputFile; a failed write leaves no file
+bool writeImageFile(const std::string& outputFile, const QByteArray& data, std::string* error = nullptr);
+
+// Decodes inputFile (applying its EXIF orientation) and writes it to outputFile
+// in 'output' format. Transparency is flattened onto white for formats without
+// an alpha channel; JPEG is written at quality 92 like ImageMagick's default.
+// A failed conversion leaves no output file.
+bool convertImageFile(const std::string& inputFile, const std::string& outputFile, FileFormat output,
+                      std::string* error = nullptr);
+
+} // namespace converter
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace converter {
+
+// Pull tokenizer for JSON. Reads the input in 64 KiB blocks and returns one
+// token per call, validating the grammar as it goes; nothing but the current
+// token and the stack of open containers is kept in memory.
+class JsonReader {
+public:
+    enum class Token {
+        BEGIN_OBJECT,
+        END_OBJECT,
+        BEGIN_ARRAY,
+        END_ARRAY,
+        KEY,          // text() holds the decoded member name
+        STRING,       // text() holds the decoded value
+        NUMBER,       // text() holds the number as written
+        TRUE_VALUE,
+        FALSE_VALUE,
+        NULL_VALUE,
+        END,          // The document ended cleanly
+        ERROR         // error() describes the problem
+    };
+
+    explicit JsonReader(std::istream& input);
+
+    Token next();
+
+    const std::string& text() const { return text_; }
+    const std::string& error() const { return error_; }
+
+    // Number of containers open after the last token
+    std::size_t depth() const { return stack_.size(); }
+
+private:
+    enum class State {
+        VALUE,         // A value is expected
+        OBJECT_START,  // Just after '{': a key or '}'
+        ARRAY_START,   // Just after '[': a value or ']'
+        MEMBER,        // A key is expected
+        AFTER_VALUE,   // A value ended: ',', a closing bracket or end of input
+        DONE
+    };
+
+    int peek();
+    int get();
+    void skipWhitespace();
+    bool parseString();
+    bool parseNumber();
+    bool parseLiteral(const char* literal);
+    Token scalar();
+    Token fail(const std::string& message);
+
+    std::istream& input_;
+    std::vector<char> buffer_;
+    std::size_t pos_ = 0;
+    std::size_t end_ = 0;
+    std::size_t consumed_ = 0;  // Bytes consumed before the current buffer
+
+    State state_ = State::VALUE;
+    std::vector<bool> stack_;   // true for arrays, false for objects
+    std::string text_;
+    std::string error_;
+};
+
+// Appends 'value' to 'out' as a quoted, escaped JSON string
+void appendJsonString(std::string& out, const std::string& value);
+
+// Appends the value that starts with 'token' (already returned by 'reader')
+// to 'out' as compact JSON, consuming the rest of it from the reader.
+// Returns false if the reader fails before the value is complete.
+bool appendJsonValue(JsonReader& reader, JsonReader::Token token, std::string& out);
+
+} // namespace converter
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+
+namespace converter {
+
+// Renders a JSON document as indented plain text:
+//
+//   key: value          object members
+//   - value             array elements
+//   key:                containers open a new line and indent by two spaces
+//     nested: value
+//
+// The input is tokenized incrementally and text is written as soon as each
+// token is complete, so memory stays bounded by the largest single string and
+// the nesting depth. Open containers live on an explicit stack, so deeply
+// nested documents cannot overflow the call stack. Members keep their document
+// order. Numbers are printed with six significant digits.
+//
+// Returns false on malformed input, with a description in 'error' (if given).
+// Output written before the error is left in 'output'.
+bool renderJsonText(std::istream& input, std::ostream& output, std::string* error = nullptr);
+
+// File wrapper; the output file is removed when the input is not valid JSON
+bool renderJsonTextFile(const std::string& inputPath, const std::string& outputPath, std::string* error = nullptr);
+
+} // namespace converter
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+namespace converter {
+
+// Memory mapping of a whole input file. COPY_ON_WRITE mappings can be modified
+// in place without touching the file on disk; only the pages actually written
+// are copied by the kernel.
+class MappedFile {
+public:
+    enum class Mode {
+        READ_ONLY,
+        COPY_ON_WRITE
+    };
+    
+    MappedFile() = default;
+    ~MappedFile();
+    
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    // Maps the file; fails for empty or unmappable files (pipes, devices)
+    bool open(const std::string& path, Mode mode = Mode::READ_ONLY);
+    void close();
+    
+    bool isOpen() const { return data_ != nullptr; }
+    char* data() { return data_; }
+    const char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+    
+    // Hint that the mapping will be read front to back (aggressive read-ahead)
+    void adviseSequential();
+    // Hint that a processed range is no longer needed so memory stays bounded
+    void adviseDone(std::size_t offset, std::size_t length);
+    
+private:
+    char* data_ = nullptr;
+    std::size_t size_ = 0;
+#ifdef _WIN32
+    void* fileHandle_ = nullptr;
+    void* mappingHandle_ = nullptr;
+#endif
+};
+
+} // namespace converter
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <QStringList>
+#include <QTemporaryDir>
+
+namespace converter {
+
+// Pool of long-lived headless LibreOffice instances, each with its own user
+// profile so they can convert in parallel. A "soffice --convert-to" call that
+// names a worker's profile is handed over to the already running instance via
+// LibreOffice's single-instance pipe, so documents no longer pay the multi-second
+// cold start. Workers are health-checked before use and restarted after a crash.
+class OfficeWorkerPool {
+public:
+    // Exclusive use of one worker for the duration of a conversion
+    class Lease {
+    public:
+        Lease(OfficeWorkerPool* pool, std::size_t slot) : pool_(pool), slot_(slot) {}
+        ~Lease();
+        Lease(Lease&& other) noexcept;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        Lease& operator=(Lease&&) = delete;
+        
+        // soffice arguments that route a command to this worker's instance
+        QStringList arguments() const;
+        // Health check: the instance is alive and holds its profile
+        bool isHealthy() const;
+        // Restarts a crashed instance; false if it cannot be brought back
+        bool restart();
+        std::size_t slot() const { return slot_; }
+        
+    private:
+        OfficeWorkerPool* pool_;
+        std::size_t slot_;
+    };
+    
+    OfficeWorkerPool(const std::string& sofficePath, std::size_t workerCount);
+    // Shuts down every instance and removes the worker profiles
+    ~OfficeWorkerPool();
+    
+    OfficeWorkerPool(const OfficeWorkerPool&) = delete;
+    OfficeWorkerPool& operator=(const OfficeWorkerPool&) = delete;
+    
+    // Blocks until a worker is free; starts its instance if needed
+    Lease acquire();
+    
+    std::size_t size() const { return workers_.size(); }
+    
+private:
+    struct Worker {
+        std::string profileDir;
+        long long pid = 0;
+        long long processGroup = 0;     // Group of the wrapper and soffice.bin (Unix)
+        bool busy = false;
+        int restarts = 0;
+    };
+    
+    void release(std::size_t slot);
+    bool ensureRunning(Worker& worker);
+    bool startWorker(Worker& worker);
+    // Terminates the instance and waits for it to exit; false if it is still
+    // running, in which case its profile must not be reused
+    bool stopWorker(Worker& worker);
+    bool isRunning(const Worker& worker) const;
+    static QString profileUrl(const Worker& worker);
+    
+    std::string sofficePath_;
+    // Unique per pool, so two pools never share profiles or pipe names;
+    // removed with everything in it when the pool is destroyed
+    QTemporaryDir baseDir_;
+    std::vector<Worker> workers_;
+    std::mutex mutex_;
+    std::condition_variable workerAvailable_;
+};
+
+} // namespace converter
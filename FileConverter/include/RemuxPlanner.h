@@ -0,0 +1,42 @@
+#pragma once
+
+#include "FormatTable.h"
+#include <string>
+#include <vector>
+
+namespace converter {
+
+// Decides when an audio/video conversion is only a container change, so FFmpeg
+// can copy the encoded streams ("-c copy") instead of decoding and re-encoding
+// them. The streams of the input come from ffprobe.
+
+// One stream of a media file as reported by ffprobe
+struct MediaStream {
+    std::string type;   // "video", "audio", "subtitle", "data" or "attachment"
+    std::string codec;  // FFmpeg codec name, e.g. "h264", "aac", "subrip"
+};
+
+// Arguments that make ffprobe print one "codec_name=...|codec_type=..." line per stream
+std::vector<std::string> probeArguments(const std::string& inputFile);
+
+// Parses the output of an ffprobe run with probeArguments()
+std::vector<MediaStream> parseProbeStreams(const std::string& output);
+
+// Whether 'container' can hold a stream of 'codec' as it is
+bool containerAccepts(FileFormat container, const std::string& codec);
+
+// Whether some codec stored in 'input' files can be copied into 'output' at all.
+// Pairs without one (e.g. WAV to MP3) always transcode and need no probe.
+bool mayStreamCopy(FileFormat input, FileFormat output);
+
+// Whether converting a file with these streams to 'output' needs no re-encoding:
+// every stream FFmpeg would map into the output is accepted by the container.
+// Video outputs take the video, audio and subtitle streams; audio outputs only
+// the audio streams, of which there must be at least one. 'reason' names the
+// first stream that needs encoding.
+bool canStreamCopy(const std::vector<MediaStream>& streams, FileFormat output, std::string* reason = nullptr);
+
+// FFmpeg output options for a stream copy into 'output'
+std::vector<std::string> streamCopyOptions(FileFormat output);
+
+} // namespace converter
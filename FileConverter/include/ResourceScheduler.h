@@ -0,0 +1,79 @@
+#pragma once
+
+#include "FormatTable.h"
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace converter {
+
+// How much CPU a conversion is expected to use
+enum class CostClass {
+    LIGHT,      // Single-threaded: text, data, audio encoding
+    MEDIUM,     // A few threads: ImageMagick, LibreOffice
+    HEAVY       // Scales across many cores: video encoding
+};
+
+// Cost class of a conversion to outputFormat run by 'backend'
+CostClass costClassFor(Backend backend, FileFormat outputFormat);
+
+const char* costClassName(CostClass cost);
+
+// Shares a fixed number of cores between concurrent conversions. Each conversion
+// holds as many cores as the thread budget of its cost class and hands that
+// budget to its tool (ffmpeg -threads, magick -limit thread), so the tools
+// together never run more threads than there are cores. Requests are granted in
+// arrival order: a heavy conversion waiting for cores is not overtaken by a
+// stream of light ones.
+class ResourceScheduler {
+public:
+    // Cores held by one conversion; released on destruction
+    class Lease {
+    public:
+        Lease(ResourceScheduler* scheduler, std::size_t threads) : scheduler_(scheduler), threads_(threads) {}
+        ~Lease();
+        Lease(Lease&& other) noexcept;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        Lease& operator=(Lease&&) = delete;
+
+        // Threads the tool may use
+        std::size_t threads() const { return threads_; }
+
+    private:
+        ResourceScheduler* scheduler_;
+        std::size_t threads_;
+    };
+
+    // cores 0 uses one per hardware thread. Default budgets: LIGHT 1, MEDIUM 2,
+    // HEAVY half the cores (at least 2, at most 8, where encoders stop scaling).
+    explicit ResourceScheduler(std::size_t cores = 0);
+
+    ResourceScheduler(const ResourceScheduler&) = delete;
+    ResourceScheduler& operator=(const ResourceScheduler&) = delete;
+
+    // Overrides a budget; clamped to 1..cores()
+    void setThreadBudget(CostClass cost, std::size_t threads);
+    std::size_t threadBudget(CostClass cost) const;
+
+    // Blocks until the budget of 'cost' is free, in arrival order
+    Lease acquire(CostClass cost);
+
+    std::size_t cores() const { return cores_; }
+    // Cores held by running conversions
+    std::size_t inUse() const;
+
+private:
+    void release(std::size_t threads);
+
+    std::size_t cores_;
+    std::size_t budgets_[3];
+    std::size_t inUse_ = 0;
+    std::uint64_t nextTicket_ = 0;      // Handed to each acquire() call
+    std::uint64_t servingTicket_ = 0;   // Oldest waiting request
+    mutable std::mutex mutex_;
+    std::condition_variable released_;
+};
+
+} // namespace converter
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+
+namespace converter {
+
+// In-process conversions between CSV, JSON and XML. All of them stream: input
+// is tokenized incrementally and output is written in blocks, so memory is
+// bounded by the largest record rather than the file. Each returns false with
+// a description in 'error' (if given) on malformed input, and removes the
+// partial output file.
+//
+// Shapes on each side:
+//   CSV   first record is the header, every further record is a row
+//   JSON  an array of objects, one per row (a lone object is a single row)
+//   XML   <records><record><column>value</column>...</record>...</records>;
+//         attributes of a record element count as columns as well
+//
+// CSV values are always strings. Nested JSON values become compact JSON text
+// in a CSV cell. Keys that are not valid XML names are sanitised (see
+// xmlElementName). A JSON array of records maps to <records>/<record> and back,
+// nested arrays to repeated <item> elements; empty objects and arrays nested in
+// a document come back as empty strings. CSV output is written in one pass
+// unless a later row brings a new column; then the input is read a second time
+// to collect the union of column names, in first-seen order.
+
+bool convertCsvToJson(const std::string& inputPath, const std::string& outputPath, std::string* error = nullptr);
+bool convertJsonToCsv(const std::string& inputPath, const std::string& outputPath, std::string* error = nullptr);
+bool convertCsvToXml(const std::string& inputPath, const std::string& outputPath, std::string* error = nullptr);
+bool convertXmlToCsv(const std::string& inputPath, const std::string& outputPath, std::string* error = nullptr);
+bool convertJsonToXml(const std::string& inputPath, const std::string& outputPath, std::string* error = nullptr);
+bool convertXmlToJson(const std::string& inputPath, const std::string& outputPath, std::string* error = nullptr);
+
+} // namespace converter
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+namespace converter {
+
+// Chunk size used by the streaming text transforms (1 MiB)
+constexpr std::size_t kTransformChunkSize = 1 << 20;
+
+// Streams inputFile into outputFile, replacing every occurrence of the byte
+// 'from' with 'to'. Regular files are memory-mapped copy-on-write and written
+// straight from the mapping; anything else is streamed in large binary chunks.
+// Memory use stays bounded, so files larger than RAM are handled, and the
+// output is only flushed once at the end. Line endings pass through unchanged;
+// a trailing newline is appended when a non-empty input lacks one (as the
+// line-based converters did).
+bool translateFile(const std::string& inputFile, const std::string& outputFile, char from, char to);
+
+// Converts CSV to space-separated text: delimiters outside quoted fields become
+// spaces, field quotes are dropped and doubled quotes inside them collapse to
+// one. Line breaks inside quoted fields are kept.
+// The input is mapped and split into chunks; the quote state at each chunk
+// start follows from the parity of the quotes before it, so chunks are
+// transformed independently on 'threads' workers (0 = one per hardware thread)
+// and written in order. Memory stays bounded by two chunks per worker.
+bool csvToTextFile(const std::string& inputFile, const std::string& outputFile, std::size_t threads = 0);
+
+// Transforms one chunk of CSV as described above. 'inQuotes' is the quote
+// state at the chunk start and 'previous' the byte before it ('\0' at the
+// start of the file). Writes at most 'length' bytes to 'out' and returns how
+// many were written.
+std::size_t csvToTextChunk(const char* data, std::size_t length, bool inQuotes, char previous, char* out);
+
+} // namespace converter
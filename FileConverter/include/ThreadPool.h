@@ -0,0 +1,51 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace converter {
+
+// Fixed-size pool of worker threads consuming a FIFO task queue
+class ThreadPool {
+public:
+    // threadCount 0 picks one worker per hardware thread. With maxQueued > 0 the
+    // queue is bounded: submit() blocks while that many tasks are waiting, which
+    // pushes back on producers instead of letting the backlog grow without limit.
+    explicit ThreadPool(std::size_t threadCount = 0, std::size_t maxQueued = 0);
+    // Finishes all queued tasks, then joins the workers
+    ~ThreadPool();
+    
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    
+    // Blocks while a bounded queue is full
+    void submit(std::function<void()> task);
+    
+    // Blocks until every submitted task has completed
+    void wait();
+    
+    std::size_t size() const { return workers_.size(); }
+    // Tasks waiting for a worker
+    std::size_t queued();
+    static std::size_t defaultThreadCount();
+    
+private:
+    void workerLoop();
+    
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable taskAvailable_;
+    std::condition_variable allDone_;
+    std::condition_variable spaceAvailable_;
+    std::size_t maxQueued_;
+    std::size_t activeTasks_ = 0;
+    bool stopping_ = false;
+};
+
+} // namespace converter
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+
+namespace converter {
+
+// Information about an external conversion tool (pandoc, magick, ffmpeg, ffprobe, soffice)
+struct ToolInfo {
+    std::string name;
+    std::string path;     // Absolute path of the executable, empty if not found
+    std::string version;  // First line of the tool's version output
+    bool available = false;
+};
+
+// Process-wide registry of external tools. Each tool is discovered lazily the
+// first time it is requested and the result is cached, so conversions no longer
+// spawn a "--version" probe before every run.
+class ToolRegistry {
+public:
+    static ToolRegistry& instance();
+
+    // Returns the cached tool information, probing the tool on first use
+    ToolInfo lookup(const std::string& name);
+    bool isAvailable(const std::string& name);
+
+    // Drop cached results so tools installed while running are picked up
+    void refresh();
+
+    // Names of all tools the converter knows how to use
+    static std::vector<std::string> knownTools();
+
+private:
+    ToolRegistry() = default;
+    ToolRegistry(const ToolRegistry&) = delete;
+    ToolRegistry& operator=(const ToolRegistry&) = delete;
+
+    static ToolInfo probe(const std::string& name);
+
+    std::mutex mutex_;
+    std::map<std::string, ToolInfo> tools_;
+};
+
+} // namespace converter
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace converter {
+
+// Pull parser for the XML subset used by data exports: elements, attributes,
+// character data, CDATA sections and the predefined and numeric entities.
+// The prolog, comments, processing instructions and DOCTYPE are skipped.
+// Input is read in 64 KiB blocks; only the current token and the names of
+// the open elements are kept in memory.
+class XmlReader {
+public:
+    enum class Token {
+        START_ELEMENT,  // name() and attributes() describe the element
+        END_ELEMENT,    // name() is the element being closed
+        TEXT,           // text() holds decoded character data
+        END,            // The root element was closed
+        ERROR           // error() describes the problem
+    };
+
+    using Attributes = std::vector<std::pair<std::string, std::string>>;
+
+    explicit XmlReader(std::istream& input);
+
+    Token next();
+
+    const std::string& name() const { return name_; }
+    const Attributes& attributes() const { return attributes_; }
+    const std::string& text() const { return text_; }
+    const std::string& error() const { return error_; }
+
+    // Number of elements open after the last token
+    std::size_t depth() const { return open_.size(); }
+
+private:
+    int peek();
+    int get();
+    bool skipUntil(const char* terminator);
+    bool readName(std::string& name);
+    bool readEntity(std::string& out);
+    bool readAttributes();
+    void skipWhitespace();
+    Token fail(const std::string& message);
+
+    std::istream& input_;
+    std::vector<char> buffer_;
+    std::size_t pos_ = 0;
+    std::size_t end_ = 0;
+    std::size_t consumed_ = 0;
+
+    std::vector<std::string> open_;
+    bool pendingEnd_ = false;   // A self-closing element still owes its END_ELEMENT
+    bool rootSeen_ = false;
+    bool done_ = false;
+    std::string name_;
+    Attributes attributes_;
+    std::string text_;
+    std::string error_;
+};
+
+// Appends 'text' to 'out' with &, <, > and quotes escaped
+void appendXmlEscaped(std::string& out, const std::string& text);
+
+// Turns an arbitrary key into a valid element name: characters outside
+// [A-Za-z0-9_.-] become '_', and names starting with a digit, '.' or '-'
+// (or empty ones) get a leading '_'
+std::string xmlElementName(const std::string& key);
+
+} // namespace converter
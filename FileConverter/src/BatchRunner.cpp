@@ -0,0 +1,264 @@
+#include "BatchRunner.h"
+#include "ThreadPool.h"
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+
+namespace converter {
+
+namespace {
+
+bool isGlobPattern(const std::string& source) {
+    return source.find_first_of("*?[") != std::string::npos;
+}
+
+// Builds the output path: same base name with the target extension, placed in
+// outputDir (keeping relativeDir) or next to the input when outputDir is empty
+std::string makeOutputPath(const QFileInfo& input, const BatchOptions& options, const QString& relativeDir) {
+    QString fileName = input.completeBaseName() + QString::fromStdString(FileConverter::getExtension(options.targetFormat));
+    
+    if (options.outputDir.empty()) {
+        return QDir(input.absolutePath()).filePath(fileName).toStdString();
+    }
+    
+    QDir outputDir(QString::fromStdString(options.outputDir));
+    if (!relativeDir.isEmpty() && relativeDir != ".") {
+        outputDir.mkpath(relativeDir);
+        outputDir = QDir(outputDir.filePath(relativeDir));
+    }
+    return outputDir.filePath(fileName).toStdString();
+}
+
+void addItem(const QFileInfo& input, const BatchOptions& options, const QString& relativeDir,
+             std::vector<BatchItem>& items) {
+    BatchItem item;
+    if (BatchRunner::makeItem(input.absoluteFilePath().toStdString(), options, relativeDir.toStdString(), item)) {
+        items.push_back(item);
+    }
+}
+
+// Inputs that differ only in extension (a.png, a.jpg) map to the same output;
+// converting both would have them write the same file at once. The first keeps it.
+void removeDuplicateOutputs(std::vector<BatchItem>& items) {
+    std::map<std::string, std::string> producers;
+    std::vector<BatchItem> unique;
+    unique.reserve(items.size());
+    for (BatchItem& item : items) {
+        auto inserted = producers.emplace(item.outputFile, item.inputFile);
+        if (!inserted.second) {
+            std::cerr << "Skipping " << item.inputFile << ": " << item.outputFile << " is already converted from "
+                      << inserted.first->second << std::endl;
+            continue;
+        }
+        unique.push_back(std::move(item));
+    }
+    items.swap(unique);
+}
+
+bool isDocumentJob(const BatchItem& item) {
+    return routeFor(FileConverter::detectInputFormat(item.inputFile),
+                    FileConverter::detectFormat(item.outputFile)) == Backend::LIBREOFFICE;
+}
+
+bool isImageJob(const BatchItem& item) {
+    return categoryOf(FileConverter::detectInputFormat(item.inputFile)) == FormatCategory::IMAGE &&
+           categoryOf(FileConverter::detectFormat(item.outputFile)) == FormatCategory::IMAGE;
+}
+
+} // namespace
+
+BatchRunner::BatchRunner(FileConverter& converter) : converter_(converter) {}
+
+bool BatchRunner::makeItem(const std::string& inputFile, const BatchOptions& options,
+                           const std::string& relativeDir, BatchItem& item) {
+    QFileInfo input(QString::fromStdString(inputFile));
+    FileFormat format = FileConverter::detectFormat(input.fileName().toStdString());
+    
+    // Skip files we cannot read and files already in the target format
+    if (format == FileFormat::UNKNOWN || format == options.targetFormat) {
+        return false;
+    }
+    
+    item = BatchItem();
+    item.inputFile = input.absoluteFilePath().toStdString();
+    item.outputFile = makeOutputPath(input, options, QString::fromStdString(relativeDir));
+    return true;
+}
+
+bool BatchRunner::collect(const BatchOptions& options, std::vector<BatchItem>& items) {
+    if (options.targetFormat == FileFormat::UNKNOWN) {
+        std::cerr << "Unknown target format!" << std::endl;
+        return false;
+    }
+    
+    if (!options.outputDir.empty() && !QDir().mkpath(QString::fromStdString(options.outputDir))) {
+        std::cerr << "Cannot create output directory: " << options.outputDir << std::endl;
+        return false;
+    }
+    
+    QString source = QString::fromStdString(options.source);
+    QFileInfo sourceInfo(source);
+    
+    // Directory: every convertible file, optionally recursing and mirroring subdirectories
+    if (sourceInfo.isDir()) {
+        QDir root(sourceInfo.absoluteFilePath());
+        QDirIterator it(root.absolutePath(), QDir::Files,
+                        options.recursive ? QDirIterator::Subdirectories : QDirIterator::NoIteratorFlags);
+        while (it.hasNext()) {
+            QFileInfo file(it.next());
+            addItem(file, options, root.relativeFilePath(file.absolutePath()), items);
+        }
+        removeDuplicateOutputs(items);
+        return true;
+    }
+    
+    // Glob: wildcard in the file name part, e.g. "photos/*.png"
+    if (isGlobPattern(options.source)) {
+        QDir dir(sourceInfo.path());
+        for (const QFileInfo& file : dir.entryInfoList(QStringList() << sourceInfo.fileName(), QDir::Files, QDir::Name)) {
+            addItem(file, options, QString(), items);
+        }
+        removeDuplicateOutputs(items);
+        return true;
+    }
+    
+    // List file: one input path per line, blank lines and '#' comments ignored
+    std::ifstream list(options.source);
+    if (!list) {
+        std::cerr << "Cannot open batch source: " << options.source << std::endl;
+        return false;
+    }
+    
+    std::string line;
+    while (std::getline(list, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        
+        QFileInfo file(QString::fromStdString(line));
+        if (!file.isFile()) {
+            std::cerr << "Skipping missing file: " << line << std::endl;
+            continue;
+        }
+        addItem(file, options, QString(), items);
+    }
+    removeDuplicateOutputs(items);
+    return true;
+}
+
+std::size_t BatchRunner::run(std::vector<BatchItem>& items, std::size_t jobs, std::ostream& log) {
+    std::mutex logMutex;
+    
+    auto report = [&log, &logMutex](const BatchItem& item) {
+        std::lock_guard<std::mutex> lock(logMutex);
+        log << (item.success ? "[ OK ] " : "[FAIL] ") << item.inputFile << " -> " << item.outputFile
+            << " (" << std::fixed << std::setprecision(2) << item.seconds << "s)" << std::endl;
+    };
+    
+    // Office documents are converted many per soffice run, split into one
+    // share per LibreOffice worker so the shares run in parallel
+    std::vector<BatchItem*> documents;
+    std::vector<BatchItem*> images;
+    std::vector<BatchItem*> others;
+    for (BatchItem& item : items) {
+        if (isDocumentJob(item)) {
+            documents.push_back(&item);
+        } else if (isImageJob(item)) {
+            images.push_back(&item);
+        } else {
+            others.push_back(&item);
+        }
+    }
+    
+    std::size_t shareCount = std::max<std::size_t>(1, std::min(converter_.officeWorkers(), documents.size()));
+    std::vector<std::vector<BatchItem*>> shares(shareCount);
+    for (std::size_t i = 0; i < documents.size(); ++i) {
+        shares[i % shareCount].push_back(documents[i]);
+    }
+    
+    // --jobs bounds the conversions running at once. The image pipeline runs its
+    // own workers, so it gets a share of them proportional to its items and the
+    // pool the rest; with a single worker the images follow the pool instead.
+    std::size_t workers = jobs > 0 ? jobs : ThreadPool::defaultThreadCount();
+    std::size_t imageWorkers = 0;
+    if (images.size() == items.size()) {
+        imageWorkers = workers;
+    } else if (!images.empty()) {
+        imageWorkers = std::min(workers - 1, std::max<std::size_t>(1, workers * images.size() / items.size()));
+    }
+    
+    auto convertImages = [this, &images, &report](std::size_t threads) {
+        std::vector<ConversionJob> conversions;
+        for (BatchItem* item : images) {
+            conversions.push_back({item->inputFile, item->outputFile});
+        }
+        converter_.convertImages(conversions, threads, [&images, &report](std::size_t index, bool success, double seconds) {
+            images[index]->success = success;
+            images[index]->seconds = seconds;
+            report(*images[index]);
+        });
+    };
+    
+    {
+        ThreadPool pool(std::max<std::size_t>(1, workers - imageWorkers));
+        
+        for (std::vector<BatchItem*>& share : shares) {
+            if (share.empty()) {
+                continue;
+            }
+            pool.submit([this, &share, &report] {
+                std::vector<ConversionJob> conversions;
+                for (BatchItem* item : share) {
+                    conversions.push_back({item->inputFile, item->outputFile});
+                }
+                
+                auto start = std::chrono::steady_clock::now();
+                std::vector<bool> results = converter_.convertDocuments(conversions);
+                double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                
+                // Time is shared by the whole run; report the per-document average
+                for (std::size_t i = 0; i < share.size(); ++i) {
+                    share[i]->success = results[i];
+                    share[i]->seconds = seconds / static_cast<double>(share.size());
+                    report(*share[i]);
+                }
+            });
+        }
+        
+        for (BatchItem* item : others) {
+            pool.submit([this, item, &report] {
+                auto start = std::chrono::steady_clock::now();
+                item->success = converter_.convert(item->inputFile, item->outputFile);
+                item->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                report(*item);
+            });
+        }
+        
+        // Raster images go through the converter's read/decode/encode pipeline;
+        // this thread feeds it while the pool works
+        if (imageWorkers > 0) {
+            convertImages(imageWorkers);
+        }
+        
+        pool.wait();
+    }
+    if (!images.empty() && imageWorkers == 0) {
+        convertImages(1);
+    }
+    
+    // Counted here rather than when reporting: a job that threw never reported
+    return static_cast<std::size_t>(std::count_if(items.begin(), items.end(),
+                                                  [](const BatchItem& item) { return !item.success; }));
+}
+
+} // namespace converter
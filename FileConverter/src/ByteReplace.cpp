@@ -0,0 +1,162 @@
+#include "ByteReplace.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CONVERTER_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang need per-function target attributes to emit AVX2 without -mavx2
+#if defined(CONVERTER_X86) && (defined(__GNUC__) || defined(__clang__))
+#define CONVERTER_TARGET_AVX2 __attribute__((target("avx2")))
+#define CONVERTER_TARGET_SSE2 __attribute__((target("sse2")))
+#else
+#define CONVERTER_TARGET_AVX2
+#define CONVERTER_TARGET_SSE2
+#endif
+
+namespace converter {
+
+namespace {
+
+void replaceScalar(char* data, std::size_t size, char from, char to) {
+    for (std::size_t i = 0; i < size; ++i) {
+        if (data[i] == from) {
+            data[i] = to;
+        }
+    }
+}
+
+#ifdef CONVERTER_X86
+
+CONVERTER_TARGET_SSE2
+void replaceSse2(char* data, std::size_t size, char from, char to) {
+    const __m128i needle = _mm_set1_epi8(from);
+    const __m128i replacement = _mm_set1_epi8(to);
+    
+    std::size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i mask = _mm_cmpeq_epi8(block, needle);
+        if (_mm_movemask_epi8(mask) == 0) {
+            continue;
+        }
+        // SSE2 has no byte blend: (block & ~mask) | (replacement & mask)
+        block = _mm_or_si128(_mm_andnot_si128(mask, block), _mm_and_si128(mask, replacement));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), block);
+    }
+    
+    replaceScalar(data + i, size - i, from, to);
+}
+
+CONVERTER_TARGET_AVX2
+void replaceAvx2(char* data, std::size_t size, char from, char to) {
+    const __m256i needle = _mm256_set1_epi8(from);
+    const __m256i replacement = _mm256_set1_epi8(to);
+    
+    std::size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i mask = _mm256_cmpeq_epi8(block, needle);
+        if (_mm256_testz_si256(mask, mask)) {
+            continue;
+        }
+        block = _mm256_blendv_epi8(block, replacement, mask);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i), block);
+    }
+    
+    // Finish the tail with the SSE2 kernel, which handles its own scalar remainder
+    replaceSse2(data + i, size - i, from, to);
+}
+
+bool cpuHasAvx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    bool osSavesYmm = (info[2] & (1 << 27)) && ((_xgetbv(0) & 0x6) == 0x6);
+    __cpuidex(info, 7, 0);
+    return osSavesYmm && (info[1] & (1 << 5));
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+bool cpuHasSse2() {
+#if defined(__x86_64__) || defined(_M_X64)
+    return true; // Part of the x86-64 baseline
+#elif defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[3] & (1 << 26)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+#endif
+}
+
+#endif // CONVERTER_X86
+
+SimdLevel probeSimdLevel() {
+#ifdef CONVERTER_X86
+    if (cpuHasAvx2()) {
+        return SimdLevel::AVX2;
+    }
+    if (cpuHasSse2()) {
+        return SimdLevel::SSE2;
+    }
+#endif
+    return SimdLevel::SCALAR;
+}
+
+} // namespace
+
+SimdLevel detectSimdLevel() {
+    static const SimdLevel level = probeSimdLevel();
+    return level;
+}
+
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::AVX2: return "AVX2";
+        case SimdLevel::SSE2: return "SSE2";
+        default: return "scalar";
+    }
+}
+
+void replaceByte(char* data, std::size_t size, char from, char to) {
+    replaceByteWith(detectSimdLevel(), data, size, from, to);
+}
+
+void replaceByteWith(SimdLevel level, char* data, std::size_t size, char from, char to) {
+    if (from == to || size == 0) {
+        return;
+    }
+    
+    // Never run a kernel the CPU cannot execute
+    if (level > detectSimdLevel()) {
+        level = detectSimdLevel();
+    }
+    
+    switch (level) {
+#ifdef CONVERTER_X86
+        case SimdLevel::AVX2:
+            replaceAvx2(data, size, from, to);
+            return;
+        case SimdLevel::SSE2:
+            replaceSse2(data, size, from, to);
+            return;
+#endif
+        default:
+            replaceScalar(data, size, from, to);
+            return;
+    }
+}
+
+} // namespace converter
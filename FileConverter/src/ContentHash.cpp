@@ -0,0 +1,168 @@
+#include "ContentHash.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace converter {
+
+namespace {
+
+constexpr std::uint64_t kPrime1 = 11400714785074694791ULL;
+constexpr std::uint64_t kPrime2 = 14029467366897019727ULL;
+constexpr std::uint64_t kPrime3 = 1609587929392839161ULL;
+constexpr std::uint64_t kPrime4 = 9650029242287828579ULL;
+constexpr std::uint64_t kPrime5 = 2870177450012600261ULL;
+
+// Files that cannot be mapped are read in blocks of this size (1 MiB)
+constexpr std::size_t kHashReadSize = 1 << 20;
+
+inline std::uint64_t rotateLeft(std::uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+// Little-endian loads; memcpy compiles to a single move on x86 and ARM
+inline std::uint64_t read64(const unsigned char* p) {
+    std::uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline std::uint32_t read32(const unsigned char* p) {
+    std::uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline std::uint64_t round(std::uint64_t accumulator, std::uint64_t input) {
+    accumulator += input * kPrime2;
+    return rotateLeft(accumulator, 31) * kPrime1;
+}
+
+inline std::uint64_t mergeRound(std::uint64_t hash, std::uint64_t accumulator) {
+    hash ^= round(0, accumulator);
+    return hash * kPrime1 + kPrime4;
+}
+
+// Consumes whole 32-byte stripes and returns the number of bytes used
+std::size_t consumeStripes(std::uint64_t (&accumulators)[4], const unsigned char* p, std::size_t length) {
+    std::size_t used = 0;
+    while (length - used >= 32) {
+        accumulators[0] = round(accumulators[0], read64(p + used));
+        accumulators[1] = round(accumulators[1], read64(p + used + 8));
+        accumulators[2] = round(accumulators[2], read64(p + used + 16));
+        accumulators[3] = round(accumulators[3], read64(p + used + 24));
+        used += 32;
+    }
+    return used;
+}
+
+} // namespace
+
+ContentHasher::ContentHasher(std::uint64_t seed)
+    : accumulators_{seed + kPrime1 + kPrime2, seed + kPrime2, seed, seed - kPrime1}, seed_(seed) {}
+
+void ContentHasher::update(const void* data, std::size_t length) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    totalLength_ += length;
+    
+    // Complete a stripe left over from the previous call
+    if (buffered_ > 0) {
+        std::size_t take = std::min(length, sizeof(buffer_) - buffered_);
+        std::memcpy(buffer_ + buffered_, p, take);
+        buffered_ += take;
+        p += take;
+        length -= take;
+        if (buffered_ < sizeof(buffer_)) {
+            return;
+        }
+        consumeStripes(accumulators_, buffer_, sizeof(buffer_));
+        buffered_ = 0;
+    }
+    
+    std::size_t used = consumeStripes(accumulators_, p, length);
+    buffered_ = length - used;
+    std::memcpy(buffer_, p + used, buffered_);
+}
+
+std::uint64_t ContentHasher::digest() const {
+    std::uint64_t hash;
+    if (totalLength_ >= 32) {
+        hash = rotateLeft(accumulators_[0], 1) + rotateLeft(accumulators_[1], 7) +
+               rotateLeft(accumulators_[2], 12) + rotateLeft(accumulators_[3], 18);
+        for (std::uint64_t accumulator : accumulators_) {
+            hash = mergeRound(hash, accumulator);
+        }
+    } else {
+        hash = seed_ + kPrime5;
+    }
+    hash += totalLength_;
+    
+    const unsigned char* p = buffer_;
+    std::size_t remaining = buffered_;
+    for (; remaining >= 8; p += 8, remaining -= 8) {
+        hash ^= round(0, read64(p));
+        hash = rotateLeft(hash, 27) * kPrime1 + kPrime4;
+    }
+    if (remaining >= 4) {
+        hash ^= static_cast<std::uint64_t>(read32(p)) * kPrime1;
+        hash = rotateLeft(hash, 23) * kPrime2 + kPrime3;
+        p += 4;
+        remaining -= 4;
+    }
+    for (; remaining > 0; ++p, --remaining) {
+        hash ^= *p * kPrime5;
+        hash = rotateLeft(hash, 11) * kPrime1;
+    }
+    
+    hash ^= hash >> 33;
+    hash *= kPrime2;
+    hash ^= hash >> 29;
+    hash *= kPrime3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+std::uint64_t hashBytes(const void* data, std::size_t length, std::uint64_t seed) {
+    ContentHasher hasher(seed);
+    hasher.update(data, length);
+    return hasher.digest();
+}
+
+bool hashFile(const std::string& path, std::uint64_t& hash) {
+    MappedFile mapped;
+    if (mapped.open(path, MappedFile::Mode::READ_ONLY)) {
+        mapped.adviseSequential();
+        hash = hashBytes(mapped.data(), mapped.size());
+        return true;
+    }
+    
+    // Empty files and pipes cannot be mapped
+    std::ifstream input(path, std::ios::binary);
+    if (!input) {
+        return false;
+    }
+    ContentHasher hasher;
+    std::vector<char> buffer(kHashReadSize);
+    while (input) {
+        input.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        hasher.update(buffer.data(), static_cast<std::size_t>(input.gcount()));
+    }
+    if (input.bad()) {
+        return false;
+    }
+    hash = hasher.digest();
+    return true;
+}
+
+std::string hashToHex(std::uint64_t hash) {
+    static const char kDigits[] = "0123456789abcdef";
+    std::string hex(16, '0');
+    for (int i = 15; i >= 0; --i, hash >>= 4) {
+        hex[static_cast<std::size_t>(i)] = kDigits[hash & 0xF];
+    }
+    return hex;
+}
+
+} // namespace converter
@@ -0,0 +1,242 @@
+#include "ConversionCache.h"
+#include "ContentHash.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#if defined(__linux__)
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#elif defined(__APPLE__)
+#include <sys/clonefile.h>
+#endif
+
+namespace converter {
+
+namespace {
+
+// Part of every key; bump when the key layout changes
+constexpr const char* kCacheKeyVersion = "1";
+
+// Entries are named after their key: two 64-bit hashes in hex
+constexpr int kKeyLength = 32;
+
+// ".partial" files untouched for this long were left by a process that died
+// while storing (1 hour); younger ones may still be in flight elsewhere
+constexpr qint64 kStalePartialSecs = 60 * 60;
+
+// Copy-on-write clone of 'source' at the new path 'target'
+bool cloneFile(const std::string& source, const std::string& target) {
+#if defined(__linux__) && defined(FICLONE)
+    int input = ::open(source.c_str(), O_RDONLY | O_CLOEXEC);
+    if (input < 0) {
+        return false;
+    }
+    int output = ::open(target.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (output < 0) {
+        ::close(input);
+        return false;
+    }
+    bool cloned = ::ioctl(output, FICLONE, input) == 0;
+    ::close(output);
+    ::close(input);
+    if (!cloned) {
+        ::unlink(target.c_str());
+    }
+    return cloned;
+#elif defined(__APPLE__)
+    return ::clonefile(source.c_str(), target.c_str(), 0) == 0;
+#else
+    (void)source;
+    (void)target;
+    return false;
+#endif
+}
+
+bool hardLink(const std::string& source, const std::string& target) {
+#ifdef _WIN32
+    return CreateHardLinkA(target.c_str(), source.c_str(), nullptr) != 0;
+#else
+    return ::link(source.c_str(), target.c_str()) == 0;
+#endif
+}
+
+} // namespace
+
+ConversionCache::ConversionCache(const std::string& directory, std::uint64_t maxBytes)
+    : directory_(directory), maxBytes_(maxBytes) {
+    QDir dir(QString::fromStdString(directory));
+    if (!dir.mkpath(".")) {
+        return;
+    }
+    valid_ = true;
+
+    // Leftovers of stores that never got to rename their ".partial" file
+    const QDateTime staleBefore = QDateTime::currentDateTime().addSecs(-kStalePartialSecs);
+    const QFileInfoList partials = dir.entryInfoList(QStringList() << ".partial-*", QDir::Files | QDir::Hidden);
+    for (const QFileInfo& file : partials) {
+        if (file.lastModified() < staleBefore) {
+            QFile::remove(file.absoluteFilePath());
+        }
+    }
+
+    // Oldest first, so the least recently used entries head the recency list.
+    // In-flight ".partial" files are hidden and not listed.
+    const QFileInfoList files = dir.entryInfoList(QDir::Files, QDir::Time | QDir::Reversed);
+    for (const QFileInfo& file : files) {
+        std::string key = file.fileName().toStdString();
+        if (key.size() != kKeyLength) {
+            continue;
+        }
+        Entry entry;
+        entry.path = file.absoluteFilePath().toStdString();
+        entry.size = static_cast<std::uint64_t>(file.size());
+        entry.position = recency_.insert(recency_.end(), key);
+        totalBytes_ += entry.size;
+        entries_[key] = std::move(entry);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    evictLocked();
+}
+
+std::string ConversionCache::makeKey(const std::string& inputFile, const std::string& extension,
+                                     const std::string& parameters) const {
+    std::uint64_t contentHash = 0;
+    if (!hashFile(inputFile, contentHash)) {
+        return std::string();
+    }
+    std::string description = std::string(kCacheKeyVersion) + '\n' + extension + '\n' + parameters;
+    return hashToHex(contentHash) + hashToHex(hashBytes(description.data(), description.size()));
+}
+
+bool ConversionCache::fetch(const std::string& key, const std::string& outputFile) {
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(key);
+        if (it == entries_.end()) {
+            ++misses_;
+            return false;
+        }
+        recency_.splice(recency_.end(), recency_, it->second.position);
+        path = it->second.path;
+    }
+
+    QFile::remove(QString::fromStdString(outputFile));
+    if (!materialise(path, outputFile, hardLinks_)) {
+        // Removed behind our back (another process evicted it)
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(key);
+        if (it != entries_.end() && !QFile::exists(QString::fromStdString(path))) {
+            totalBytes_ -= it->second.size;
+            recency_.erase(it->second.position);
+            entries_.erase(it);
+        }
+        ++misses_;
+        return false;
+    }
+
+    // The modification time records recency for the next process indexing the cache
+    QFile entry(QString::fromStdString(path));
+    if (entry.open(QIODevice::ReadWrite)) {
+        entry.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    }
+
+    ++hits_;
+    return true;
+}
+
+bool ConversionCache::store(const std::string& key, const std::string& outputFile) {
+    if (!valid_) {
+        return false;
+    }
+    QFileInfo output(QString::fromStdString(outputFile));
+    std::uint64_t size = static_cast<std::uint64_t>(output.size());
+    if (!output.isFile() || size > maxBytes_) {
+        return false;
+    }
+
+    // Materialise under a private name, then rename into place so other
+    // processes never see a partial entry. Never a hard link: the entry would
+    // share its data with an output the caller is free to modify.
+    static std::atomic<unsigned> counter{0};
+    QDir dir(QString::fromStdString(directory_));
+    std::string path = dir.filePath(QString::fromStdString(key)).toStdString();
+    std::string partial = dir.filePath(QString(".partial-%1-%2")
+                                           .arg(QCoreApplication::applicationPid())
+                                           .arg(counter++)).toStdString();
+    if (!materialise(outputFile, partial, false)) {
+        return false;
+    }
+    QFile::remove(QString::fromStdString(path));
+    if (!QFile::rename(QString::fromStdString(partial), QString::fromStdString(path))) {
+        QFile::remove(QString::fromStdString(partial));
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+        totalBytes_ -= it->second.size;
+        recency_.splice(recency_.end(), recency_, it->second.position);
+    } else {
+        it = entries_.emplace(key, Entry()).first;
+        it->second.path = path;
+        it->second.position = recency_.insert(recency_.end(), key);
+    }
+    it->second.size = size;
+    totalBytes_ += size;
+    ++stores_;
+
+    evictLocked();
+    return true;
+}
+
+ConversionCache::Stats ConversionCache::stats() const {
+    Stats stats;
+    stats.hits = hits_;
+    stats.misses = misses_;
+    stats.stores = stores_;
+    stats.evictions = evictions_;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats.bytes = totalBytes_;
+    stats.entries = entries_.size();
+    return stats;
+}
+
+bool ConversionCache::materialise(const std::string& source, const std::string& target,
+                                  bool allowHardLink) const {
+    if (cloneFile(source, target)) {
+        return true;
+    }
+    if (allowHardLink && hardLink(source, target)) {
+        return true;
+    }
+    return QFile::copy(QString::fromStdString(source), QString::fromStdString(target));
+}
+
+void ConversionCache::evictLocked() {
+    while (totalBytes_ > maxBytes_ && !recency_.empty()) {
+        auto it = entries_.find(recency_.front());
+        QFile::remove(QString::fromStdString(it->second.path));
+        totalBytes_ -= it->second.size;
+        recency_.pop_front();
+        entries_.erase(it);
+        ++evictions_;
+    }
+}
+
+} // namespace converter
@@ -0,0 +1,258 @@
+#include "ConversionMetrics.h"
+#include <QSaveFile>
+#include <QString>
+#include <algorithm>
+#include <locale>
+#include <sstream>
+
+namespace converter {
+
+namespace {
+
+constexpr const char* kPrometheusPrefix = "fileconverter_";
+
+// Nine significant digits, independent of the locale
+std::string formatNumber(double value) {
+    std::ostringstream text;
+    text.imbue(std::locale::classic());
+    text.precision(9);
+    text << value;
+    return text.str();
+}
+
+// Escapes a string for a JSON literal or a Prometheus label value
+std::string escape(const std::string& text) {
+    std::string escaped;
+    escaped.reserve(text.size());
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if (c == '\n') {
+            escaped += "\\n";
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+void writeHistogramJson(std::ostream& out, const LatencyHistogram& histogram) {
+    out << "{\"count\":" << histogram.count() << ",\"sum\":" << formatNumber(histogram.sum()) << ",\"buckets\":[";
+    for (std::size_t i = 0; i < histogram.buckets().size(); ++i) {
+        out << (i > 0 ? "," : "") << histogram.buckets()[i];
+    }
+    out << "]}";
+}
+
+// Writes the _bucket, _sum and _count series of one histogram
+void writeHistogramPrometheus(std::ostream& out, const std::string& name, const std::string& labels,
+                              const LatencyHistogram& histogram) {
+    std::uint64_t cumulative = 0;
+    for (std::size_t i = 0; i < LatencyHistogram::kBucketCount; ++i) {
+        cumulative += histogram.buckets()[i];
+        out << name << "_bucket{" << labels << ",le=\"" << formatNumber(LatencyHistogram::bounds()[i]) << "\"} "
+            << cumulative << '\n';
+    }
+    out << name << "_bucket{" << labels << ",le=\"+Inf\"} " << histogram.count() << '\n';
+    out << name << "_sum{" << labels << "} " << formatNumber(histogram.sum()) << '\n';
+    out << name << "_count{" << labels << "} " << histogram.count() << '\n';
+}
+
+std::string routeLabels(const ConversionMetrics::RouteKey& key) {
+    return "from=\"" + escape(std::get<0>(key)) + "\",to=\"" + escape(std::get<1>(key)) +
+           "\",engine=\"" + escape(std::get<2>(key)) + "\"";
+}
+
+} // namespace
+
+void ConversionRecord::addTime(Phase phase, double elapsed) {
+    std::size_t index = static_cast<std::size_t>(phase);
+    seconds[index] += elapsed;
+    entered[index] = true;
+}
+
+double ConversionRecord::totalSeconds() const {
+    double total = 0.0;
+    for (double phase : seconds) {
+        total += phase;
+    }
+    return total;
+}
+
+const std::array<double, LatencyHistogram::kBucketCount>& LatencyHistogram::bounds() {
+    static const std::array<double, kBucketCount> kBounds = {
+        0.001, 0.005, 0.01, 0.05, 0.1, 0.25, 0.5, 1.0, 5.0, 30.0, 120.0, 600.0
+    };
+    return kBounds;
+}
+
+void LatencyHistogram::add(double seconds) {
+    const std::array<double, kBucketCount>& limits = bounds();
+    std::size_t bucket = static_cast<std::size_t>(
+        std::lower_bound(limits.begin(), limits.end(), seconds) - limits.begin());
+    ++buckets_[bucket];
+    ++count_;
+    sum_ += seconds;
+}
+
+void ConversionMetrics::record(const ConversionRecord& record) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    RouteMetrics& route = routes_[RouteKey(record.from, record.to, record.engine)];
+    ++route.conversions;
+    if (!record.success) {
+        ++route.failures;
+        ++route.failureReasons[record.failure];
+    }
+    route.bytesIn += record.bytesIn;
+    route.bytesOut += record.bytesOut;
+    route.total.add(record.totalSeconds());
+    for (std::size_t i = 0; i < kPhaseCount; ++i) {
+        if (record.entered[i]) {
+            route.phases[i].add(record.seconds[i]);
+        }
+    }
+}
+
+void ConversionMetrics::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    routes_.clear();
+}
+
+std::map<ConversionMetrics::RouteKey, RouteMetrics> ConversionMetrics::snapshot() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return routes_;
+}
+
+RouteMetrics ConversionMetrics::route(const RouteKey& key) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = routes_.find(key);
+    return it != routes_.end() ? it->second : RouteMetrics();
+}
+
+void ConversionMetrics::writeJsonLines(std::ostream& out) const {
+    std::map<RouteKey, RouteMetrics> routes = snapshot();
+
+    std::string bounds;
+    for (double bound : LatencyHistogram::bounds()) {
+        bounds += (bounds.empty() ? "" : ",") + formatNumber(bound);
+    }
+
+    for (const auto& entry : routes) {
+        const RouteMetrics& route = entry.second;
+        out << "{\"from\":\"" << escape(std::get<0>(entry.first)) << "\",\"to\":\"" << escape(std::get<1>(entry.first))
+            << "\",\"engine\":\"" << escape(std::get<2>(entry.first)) << "\",\"conversions\":" << route.conversions
+            << ",\"failures\":" << route.failures << ",\"failure_reasons\":{";
+        bool first = true;
+        for (const auto& reason : route.failureReasons) {
+            out << (first ? "" : ",") << '"' << failureName(reason.first) << "\":" << reason.second;
+            first = false;
+        }
+        out << "},\"bytes_in\":" << route.bytesIn << ",\"bytes_out\":" << route.bytesOut
+            << ",\"le\":[" << bounds << "],\"seconds\":";
+        writeHistogramJson(out, route.total);
+        out << ",\"phases\":{";
+        for (std::size_t i = 0; i < kPhaseCount; ++i) {
+            out << (i > 0 ? "," : "") << '"' << phaseName(static_cast<Phase>(i)) << "\":";
+            writeHistogramJson(out, route.phases[i]);
+        }
+        out << "}}\n";
+    }
+}
+
+void ConversionMetrics::writePrometheus(std::ostream& out) const {
+    std::map<RouteKey, RouteMetrics> routes = snapshot();
+    const std::string prefix = kPrometheusPrefix;
+
+    out << "# HELP " << prefix << "conversions_total Conversions attempted.\n"
+        << "# TYPE " << prefix << "conversions_total counter\n";
+    for (const auto& entry : routes) {
+        out << prefix << "conversions_total{" << routeLabels(entry.first) << "} " << entry.second.conversions << '\n';
+    }
+
+    out << "# HELP " << prefix << "failures_total Failed conversions by reason.\n"
+        << "# TYPE " << prefix << "failures_total counter\n";
+    for (const auto& entry : routes) {
+        for (const auto& reason : entry.second.failureReasons) {
+            out << prefix << "failures_total{" << routeLabels(entry.first) << ",reason=\""
+                << failureName(reason.first) << "\"} " << reason.second << '\n';
+        }
+    }
+
+    out << "# HELP " << prefix << "input_bytes_total Bytes read from inputs.\n"
+        << "# TYPE " << prefix << "input_bytes_total counter\n";
+    for (const auto& entry : routes) {
+        out << prefix << "input_bytes_total{" << routeLabels(entry.first) << "} " << entry.second.bytesIn << '\n';
+    }
+
+    out << "# HELP " << prefix << "output_bytes_total Bytes written to outputs.\n"
+        << "# TYPE " << prefix << "output_bytes_total counter\n";
+    for (const auto& entry : routes) {
+        out << prefix << "output_bytes_total{" << routeLabels(entry.first) << "} " << entry.second.bytesOut << '\n';
+    }
+
+    out << "# HELP " << prefix << "conversion_seconds Wall time of whole conversions.\n"
+        << "# TYPE " << prefix << "conversion_seconds histogram\n";
+    for (const auto& entry : routes) {
+        writeHistogramPrometheus(out, prefix + "conversion_seconds", routeLabels(entry.first), entry.second.total);
+    }
+
+    out << "# HELP " << prefix << "phase_seconds Wall time of conversions by phase.\n"
+        << "# TYPE " << prefix << "phase_seconds histogram\n";
+    for (const auto& entry : routes) {
+        for (std::size_t i = 0; i < kPhaseCount; ++i) {
+            if (entry.second.phases[i].count() == 0) {
+                continue;
+            }
+            std::string labels = routeLabels(entry.first) + ",phase=\"" + phaseName(static_cast<Phase>(i)) + "\"";
+            writeHistogramPrometheus(out, prefix + "phase_seconds", labels, entry.second.phases[i]);
+        }
+    }
+}
+
+bool ConversionMetrics::writeFile(const std::string& path) const {
+    bool prometheus = path.size() >= 5 && path.compare(path.size() - 5, 5, ".prom") == 0;
+    std::ostringstream output;
+    if (prometheus) {
+        writePrometheus(output);
+    } else {
+        writeJsonLines(output);
+    }
+
+    // Written beside the target and renamed over it in one step
+    const std::string data = output.str();
+    QSaveFile file(QString::fromStdString(path));
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(data.data(), static_cast<qint64>(data.size()));
+    return file.commit();
+}
+
+const char* ConversionMetrics::phaseName(Phase phase) {
+    switch (phase) {
+        case Phase::PROBE: return "probe";
+        case Phase::WAIT: return "wait";
+        case Phase::SPAWN: return "spawn";
+        case Phase::RUN: return "run";
+        case Phase::RENAME: return "rename";
+    }
+    return "unknown";
+}
+
+const char* ConversionMetrics::failureName(FailureReason reason) {
+    switch (reason) {
+        case FailureReason::NONE: return "none";
+        case FailureReason::UNSUPPORTED: return "unsupported";
+        case FailureReason::TOOL_MISSING: return "tool_missing";
+        case FailureReason::START_FAILED: return "start_failed";
+        case FailureReason::CRASHED: return "crashed";
+        case FailureReason::EXIT_CODE: return "exit_code";
+        case FailureReason::NO_OUTPUT: return "no_output";
+        case FailureReason::CANCELLED: return "cancelled";
+        case FailureReason::CONVERTER_ERROR: return "converter_error";
+    }
+    return "unknown";
+}
+
+} // namespace converter
@@ -0,0 +1,120 @@
+#include "ConversionProgress.h"
+#include <cstdlib>
+
+namespace converter {
+
+namespace {
+
+// Splits buffered text into complete lines, keeping any partial tail
+template <typename Handler>
+void consumeLines(std::string& buffer, const char* data, std::size_t size, Handler handler) {
+    buffer.append(data, size);
+    
+    std::size_t start = 0;
+    for (;;) {
+        // FFmpeg ends banner lines with '\n' but may use '\r' on a TTY
+        std::size_t end = buffer.find_first_of("\r\n", start);
+        if (end == std::string::npos) {
+            break;
+        }
+        if (end > start) {
+            handler(buffer.substr(start, end - start));
+        }
+        start = end + 1;
+    }
+    buffer.erase(0, start);
+}
+
+} // namespace
+
+void FfmpegProgressParser::feedLog(const char* data, std::size_t size) {
+    consumeLines(logBuffer_, data, size, [this](const std::string& line) { handleLogLine(line); });
+}
+
+bool FfmpegProgressParser::feedProgress(const char* data, std::size_t size) {
+    bool blockCompleted = false;
+    consumeLines(progressBuffer_, data, size, [this, &blockCompleted](const std::string& line) {
+        if (handleProgressLine(line)) {
+            blockCompleted = true;
+        }
+    });
+    return blockCompleted;
+}
+
+double FfmpegProgressParser::parseTimestamp(const std::string& text) {
+    char* end = nullptr;
+    
+    long hours = std::strtol(text.c_str(), &end, 10);
+    if (*end != ':') {
+        return -1.0;
+    }
+    long minutes = std::strtol(end + 1, &end, 10);
+    if (*end != ':') {
+        return -1.0;
+    }
+    double seconds = std::strtod(end + 1, &end);
+    
+    return hours * 3600.0 + minutes * 60.0 + seconds;
+}
+
+void FfmpegProgressParser::handleLogLine(const std::string& line) {
+    // Only the first input's duration matters: "  Duration: 00:01:02.34, start: ..."
+    if (progress_.totalSeconds > 0.0) {
+        return;
+    }
+    
+    std::size_t pos = line.find("Duration: ");
+    if (pos == std::string::npos) {
+        return;
+    }
+    
+    double duration = parseTimestamp(line.substr(pos + 10));
+    if (duration > 0.0) {
+        progress_.totalSeconds = duration;
+    }
+}
+
+bool FfmpegProgressParser::handleProgressLine(const std::string& line) {
+    std::size_t equals = line.find('=');
+    if (equals == std::string::npos) {
+        return false;
+    }
+    
+    std::string key = line.substr(0, equals);
+    std::string value = line.substr(equals + 1);
+    
+    if (key == "out_time_us") {
+        // "N/A" before the first frame is written
+        char* end = nullptr;
+        long long microseconds = std::strtoll(value.c_str(), &end, 10);
+        if (end != value.c_str() && microseconds >= 0) {
+            progress_.processedSeconds = microseconds / 1e6;
+        }
+    } else if (key == "fps") {
+        progress_.fps = std::strtod(value.c_str(), nullptr);
+    } else if (key == "speed") {
+        // e.g. "1.53x" or "N/A"
+        progress_.speed = std::strtod(value.c_str(), nullptr);
+    } else if (key == "progress") {
+        // Each block ends with progress=continue or progress=end
+        progress_.finished = (value == "end");
+        
+        if (progress_.totalSeconds > 0.0) {
+            double percent = progress_.processedSeconds / progress_.totalSeconds * 100.0;
+            progress_.percent = progress_.finished ? 100.0 : (percent > 100.0 ? 100.0 : percent);
+            
+            if (progress_.speed > 0.0) {
+                double remaining = progress_.totalSeconds - progress_.processedSeconds;
+                progress_.etaSeconds = remaining > 0.0 ? remaining / progress_.speed : 0.0;
+            }
+        }
+        if (progress_.finished) {
+            progress_.etaSeconds = 0.0;
+        }
+        return true;
+    }
+    
+    return false;
+}
+
+} // namespace converter
@@ -0,0 +1,35 @@
+#include "ConversionWorker.h"
+
+ConversionWorker::ConversionWorker(converter::FileConverter& converter, QObject *parent) :
+    QObject(parent),
+    fileConverter(converter)
+{
+    // Called on the worker thread; the queued signal hands it to the UI
+    fileConverter.setProgressCallback([this](const converter::ConversionProgress& progress) {
+        QString details;
+        if (progress.fps > 0.0) {
+            details += QString("%1 fps").arg(progress.fps, 0, 'f', 1);
+        }
+        if (progress.speed > 0.0) {
+            details += QString("%1%2x").arg(details.isEmpty() ? "" : ", ").arg(progress.speed, 0, 'f', 2);
+        }
+        if (progress.etaSeconds >= 0.0) {
+            details += QString("%1ETA %2s").arg(details.isEmpty() ? "" : ", ").arg(progress.etaSeconds, 0, 'f', 0);
+        }
+        
+        int percent = progress.percent >= 0.0 ? static_cast<int>(progress.percent) : 0;
+        emit progressChanged(percent, details);
+    });
+}
+
+void ConversionWorker::convert(const QString& inputFile, const QString& outputFile)
+{
+    emit conversionStarted(inputFile);
+    emit progressChanged(0, QString());
+    
+    bool success = fileConverter.convert(inputFile.toStdString(), outputFile.toStdString());
+    bool cancelled = fileConverter.isCancelled();
+    
+    emit progressChanged(100, QString());
+    emit conversionFinished(inputFile, outputFile, success && !cancelled, cancelled);
+}
@@ -0,0 +1,29 @@
+#ifndef CONVERSIONWORKER_H
+#define CONVERSIONWORKER_H
+
+#include <QObject>
+#include <QString>
+#include "../include/FileConverter.h"
+
+// Runs conversions on a background thread so the UI stays responsive.
+// Lives in its own QThread; requests arrive through the convert() slot.
+class ConversionWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ConversionWorker(converter::FileConverter& converter, QObject *parent = nullptr);
+
+public slots:
+    void convert(const QString& inputFile, const QString& outputFile);
+
+signals:
+    void conversionStarted(const QString& inputFile);
+    void progressChanged(int percent, const QString& details);
+    void conversionFinished(const QString& inputFile, const QString& outputFile, bool success, bool cancelled);
+
+private:
+    converter::FileConverter& fileConverter;
+};
+
+#endif // CONVERSIONWORKER_H
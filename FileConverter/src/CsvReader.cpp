@@ -0,0 +1,126 @@
+#include "CsvReader.h"
+#include <cstdio>
+#include <istream>
+
+namespace converter {
+
+namespace {
+
+// Input is read in blocks of this size (64 KiB)
+constexpr std::size_t kCsvReadSize = 1 << 16;
+
+} // namespace
+
+CsvReader::CsvReader(std::istream& input, char delimiter)
+    : input_(input), delimiter_(delimiter), buffer_(kCsvReadSize) {}
+
+int CsvReader::peek() {
+    if (pos_ == end_) {
+        input_.read(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+        end_ = static_cast<std::size_t>(input_.gcount());
+        pos_ = 0;
+        if (end_ == 0) {
+            return EOF;
+        }
+    }
+    return static_cast<unsigned char>(buffer_[pos_]);
+}
+
+int CsvReader::get() {
+    int c = peek();
+    if (c != EOF) {
+        ++pos_;
+    }
+    return c;
+}
+
+bool CsvReader::next(std::vector<std::string>& fields) {
+    fields.clear();
+    if (peek() == EOF) {
+        return false;
+    }
+
+    std::string field;
+    bool quoted = false;
+    bool wasQuoted = false;
+    for (;;) {
+        int c = get();
+
+        if (quoted) {
+            if (c == EOF) {
+                error_ = "unterminated quoted field in record " + std::to_string(records_ + 1);
+                return false;
+            }
+            if (c == '"') {
+                if (peek() == '"') {
+                    get();
+                    field += '"';
+                } else {
+                    quoted = false;
+                }
+            } else {
+                field += static_cast<char>(c);
+            }
+            continue;
+        }
+
+        if (c == '"' && field.empty()) {
+            quoted = true;
+            wasQuoted = true;
+        } else if (c == delimiter_) {
+            fields.push_back(std::move(field));
+            field.clear();
+        } else if (c == '\n' || c == EOF || (c == '\r' && peek() == '\n')) {
+            if (c == '\r') {
+                get();
+            }
+            if (fields.empty() && field.empty() && !wasQuoted) {
+                // Blank line
+                if (c == EOF || peek() == EOF) {
+                    return false;
+                }
+                continue;
+            }
+            fields.push_back(std::move(field));
+            ++records_;
+            return true;
+        } else {
+            field += static_cast<char>(c);
+        }
+    }
+}
+
+void appendCsvField(std::string& out, const std::string& field, char delimiter) {
+    bool needsQuotes = false;
+    for (char c : field) {
+        if (c == delimiter || c == '"' || c == '\n' || c == '\r') {
+            needsQuotes = true;
+            break;
+        }
+    }
+    if (!needsQuotes) {
+        out += field;
+        return;
+    }
+
+    out += '"';
+    for (char c : field) {
+        if (c == '"') {
+            out += '"';
+        }
+        out += c;
+    }
+    out += '"';
+}
+
+void appendCsvRecord(std::string& out, const std::vector<std::string>& fields, char delimiter) {
+    for (std::size_t i = 0; i < fields.size(); ++i) {
+        if (i > 0) {
+            out += delimiter;
+        }
+        appendCsvField(out, fields[i], delimiter);
+    }
+    out += '\n';
+}
+
+} // namespace converter
@@ -0,0 +1,238 @@
+#include "DirectorySync.h"
+#include "BatchRunner.h"
+#include "ContentHash.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <vector>
+
+namespace converter {
+
+namespace {
+
+constexpr const char* kManifestHeader = "# FileConverter sync manifest 1";
+constexpr const char* kTargetPrefix = "target ";
+constexpr const char* kDefaultManifestName = ".fileconverter-sync";
+
+// Parses "<size> <mtime> <hash hex> <input>\t<output>"
+bool parseRecord(const std::string& line, std::string& input, SyncRecord& record) {
+    const char* text = line.c_str();
+    char* end = nullptr;
+    record.size = std::strtoull(text, &end, 10);
+    if (end == text || *end != ' ') {
+        return false;
+    }
+    text = end + 1;
+    record.modified = std::strtoll(text, &end, 10);
+    if (end == text || *end != ' ') {
+        return false;
+    }
+    text = end + 1;
+    record.hash = std::strtoull(text, &end, 16);
+    if (end == text || *end != ' ') {
+        return false;
+    }
+
+    std::string paths(end + 1);
+    std::size_t tab = paths.find('\t');
+    if (tab == std::string::npos || tab == 0 || tab + 1 == paths.size()) {
+        return false;
+    }
+    input = paths.substr(0, tab);
+    record.outputFile = paths.substr(tab + 1);
+    return true;
+}
+
+// Removes a stale output, then its parent directories below 'root' that became empty
+void removeOutput(const QDir& root, const std::string& relativePath) {
+    QString path = root.filePath(QString::fromStdString(relativePath));
+    QFile::remove(path);
+
+    // rmdir fails on directories that still hold files, which ends the walk
+    QDir parent = QFileInfo(path).absoluteDir();
+    while (parent.absolutePath().startsWith(root.absolutePath() + "/")) {
+        QString name = parent.dirName();
+        if (!parent.cdUp() || !parent.rmdir(name)) {
+            break;
+        }
+    }
+}
+
+} // namespace
+
+bool SyncManifest::load(const std::string& path) {
+    records.clear();
+    targetExtension.clear();
+
+    std::ifstream input(path, std::ios::binary);
+    if (!input) {
+        return !QFileInfo::exists(QString::fromStdString(path));
+    }
+
+    std::string line;
+    if (!std::getline(input, line) || line != kManifestHeader ||
+        !std::getline(input, line) || line.compare(0, std::char_traits<char>::length(kTargetPrefix), kTargetPrefix) != 0) {
+        std::cerr << "Not a sync manifest: " << path << std::endl;
+        return false;
+    }
+    targetExtension = line.substr(std::char_traits<char>::length(kTargetPrefix));
+
+    while (std::getline(input, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        std::string inputFile;
+        SyncRecord record;
+        if (!parseRecord(line, inputFile, record)) {
+            std::cerr << "Malformed sync manifest line: " << line << std::endl;
+            return false;
+        }
+        records[inputFile] = record;
+    }
+    return !input.bad();
+}
+
+bool SyncManifest::save(const std::string& path) const {
+    std::ostringstream output;
+    output << kManifestHeader << '\n' << kTargetPrefix << targetExtension << '\n';
+    for (const auto& entry : records) {
+        // Names with tabs or line breaks cannot be stored; such files are simply reconverted
+        if (entry.first.find_first_of("\t\n") != std::string::npos ||
+            entry.second.outputFile.find_first_of("\t\n") != std::string::npos) {
+            continue;
+        }
+        output << entry.second.size << ' ' << entry.second.modified << ' ' << hashToHex(entry.second.hash)
+               << ' ' << entry.first << '\t' << entry.second.outputFile << '\n';
+    }
+
+    // Replaces the old manifest in one rename, so a crash leaves one or the other
+    const std::string data = output.str();
+    QSaveFile file(QString::fromStdString(path));
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(data.data(), static_cast<qint64>(data.size()));
+    return file.commit();
+}
+
+DirectorySync::DirectorySync(FileConverter& converter) : converter_(converter) {}
+
+bool DirectorySync::run(const SyncOptions& options, std::ostream& log, SyncSummary& summary) {
+    summary = SyncSummary();
+
+    QFileInfo sourceInfo(QString::fromStdString(options.sourceDir));
+    if (!sourceInfo.isDir()) {
+        std::cerr << "Sync source is not a directory: " << options.sourceDir << std::endl;
+        return false;
+    }
+    if (options.outputDir.empty()) {
+        std::cerr << "Sync needs an output directory" << std::endl;
+        return false;
+    }
+
+    BatchOptions batch;
+    batch.source = options.sourceDir;
+    batch.outputDir = options.outputDir;
+    batch.targetFormat = options.targetFormat;
+    batch.recursive = true;
+
+    std::vector<BatchItem> items;
+    if (!BatchRunner::collect(batch, items)) {
+        return false;
+    }
+
+    QDir sourceRoot(sourceInfo.absoluteFilePath());
+    QDir outputRoot(QFileInfo(QString::fromStdString(options.outputDir)).absoluteFilePath());
+    std::string manifestPath = options.manifestPath.empty()
+        ? outputRoot.filePath(kDefaultManifestName).toStdString()
+        : options.manifestPath;
+
+    SyncManifest previous;
+    if (!previous.load(manifestPath)) {
+        return false;
+    }
+
+    SyncManifest next;
+    next.targetExtension = FileConverter::getExtension(options.targetFormat);
+    bool sameTarget = (previous.targetExtension == next.targetExtension);
+
+    std::vector<BatchItem> pending;
+    std::vector<std::pair<std::string, SyncRecord>> pendingRecords;
+    std::set<std::string> outputs;
+
+    for (const BatchItem& item : items) {
+        QFileInfo input(QString::fromStdString(item.inputFile));
+        std::string relativeInput = sourceRoot.relativeFilePath(input.absoluteFilePath()).toStdString();
+
+        SyncRecord record;
+        QString output = QFileInfo(QString::fromStdString(item.outputFile)).absoluteFilePath();
+        record.outputFile = outputRoot.relativeFilePath(output).toStdString();
+        record.size = static_cast<std::uint64_t>(input.size());
+        record.modified = input.lastModified().toMSecsSinceEpoch();
+        outputs.insert(record.outputFile);
+        bool hashed = false;
+
+        auto old = sameTarget ? previous.records.find(relativeInput) : previous.records.end();
+        if (old != previous.records.end() && old->second.outputFile == record.outputFile &&
+            QFile::exists(QString::fromStdString(item.outputFile))) {
+            // Same size and mtime: trusted without reading the file
+            if (old->second.size == record.size && old->second.modified == record.modified) {
+                next.records[relativeInput] = old->second;
+                ++summary.unchanged;
+                continue;
+            }
+            // Touched or copied but identical content
+            hashed = hashFile(item.inputFile, record.hash);
+            if (hashed && old->second.size == record.size && old->second.hash == record.hash) {
+                next.records[relativeInput] = record;
+                ++summary.unchanged;
+                continue;
+            }
+        }
+
+        // Hashed before converting: a change made meanwhile shows up next run
+        if (!hashed) {
+            hashFile(item.inputFile, record.hash);
+        }
+        pending.push_back(item);
+        pendingRecords.emplace_back(relativeInput, record);
+    }
+
+    // Outputs no current input maps to: removed inputs, renamed inputs, other target formats
+    for (const auto& entry : previous.records) {
+        if (outputs.count(entry.second.outputFile) == 0) {
+            removeOutput(outputRoot, entry.second.outputFile);
+            log << "[ DEL] " << outputRoot.filePath(QString::fromStdString(entry.second.outputFile)).toStdString()
+                << std::endl;
+            ++summary.deleted;
+        }
+    }
+
+    if (!pending.empty()) {
+        BatchRunner runner(converter_);
+        runner.run(pending, options.jobs, log);
+    }
+    for (std::size_t i = 0; i < pending.size(); ++i) {
+        if (pending[i].success) {
+            next.records[pendingRecords[i].first] = pendingRecords[i].second;
+            ++summary.converted;
+        } else {
+            ++summary.failed;
+        }
+    }
+
+    if (!next.save(manifestPath)) {
+        std::cerr << "Cannot write sync manifest: " << manifestPath << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace converter
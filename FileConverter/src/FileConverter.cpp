@@ -1,62 +1,279 @@
 #include "FileConverter.h"
+#include "FormatSniffer.h"
+#include "TextTransform.h"
+#include "JsonText.h"
+#include "StructuredData.h"
+#include "OfficeWorkerPool.h"
+#include "ImageCodec.h"
+#include "RemuxPlanner.h"
+#include "ThreadPool.h"
 #include <QProcess>
 #include <QFile>
-#include <QTextStream>
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QJsonArray>
-#include <QDebug>
 #include <QFileInfo>
 #include <QDir>
+#include <QTemporaryDir>
 #include <iostream>
 #include <fstream>
 #include <algorithm>
+#include <chrono>
+#include <limits>
+#include <set>
 
 namespace converter {
 
+// How often a running external tool is checked for cancellation
+constexpr int kCancelPollIntervalMs = 100;
+
+// Upper bound of documents passed to one soffice run (keeps command lines short)
+constexpr std::size_t kMaxDocumentsPerRun = 64;
+
+// How long ffprobe may take to list the streams of an input
+constexpr int kProbeTimeoutMs = 10000;
+
+// Metrics engine of FFmpeg conversions that copy the streams, which take a
+// fraction of the time of those that encode
+constexpr const char* kStreamCopyEngine = "FFmpeg-copy";
+
+// Upper bound of images passed to one mogrify run
+constexpr std::size_t kMaxImagesPerRun = 64;
+
+// Largest input the image pipeline reads into memory: a Qt 5 QByteArray holds
+// at most INT_MAX bytes. Larger images go through convert().
+constexpr std::uint64_t kMaxPipelinedImageBytes = static_cast<std::uint64_t>(std::numeric_limits<int>::max());
+
+// Identifies the in-process converters in cache keys; bump whenever the output
+// of a native converter changes so stale cached results are not reused
+constexpr int kNativeEngineVersion = 1;
+
+namespace {
+
+// Conversion being measured on this thread; runProcess and the tool wrappers add
+// their phases and failure causes to it
+thread_local ConversionRecord* activeRecord = nullptr;
+
+// Adds the time until stop() or the end of the scope to a phase of the active record
+class PhaseTimer {
+public:
+    explicit PhaseTimer(Phase phase) : phase_(phase), start_(std::chrono::steady_clock::now()) {}
+    ~PhaseTimer() { stop(); }
+    
+    void stop() {
+        if (!stopped_ && activeRecord) {
+            activeRecord->addTime(phase_, std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count());
+        }
+        stopped_ = true;
+    }
+    
+private:
+    Phase phase_;
+    std::chrono::steady_clock::time_point start_;
+    bool stopped_ = false;
+};
+
+// Makes 'record' the active record of this thread until the end of the scope
+class RecordScope {
+public:
+    explicit RecordScope(ConversionRecord& record) : outer_(activeRecord) { activeRecord = &record; }
+    ~RecordScope() { activeRecord = outer_; }
+    
+private:
+    ConversionRecord* outer_;
+};
+
+// Keeps the first cause of a failure
+void noteFailure(FailureReason reason) {
+    if (activeRecord && activeRecord->failure == FailureReason::NONE) {
+        activeRecord->failure = reason;
+    }
+}
+
+// Metrics label of a format: its extension without the dot
+std::string formatLabel(FileFormat format) {
+    std::string extension = FileConverter::getExtension(format);
+    return extension.empty() ? "unknown" : extension.substr(1);
+}
+
+std::uint64_t fileSize(const std::string& path) {
+    QFileInfo info(QString::fromStdString(path));
+    return info.exists() ? static_cast<std::uint64_t>(info.size()) : 0;
+}
+
+// Input buffers passed from the reading thread to the image workers and back,
+// so a batch keeps reusing the same few allocations
+class BufferPool {
+public:
+    QByteArray take() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (free_.empty()) {
+            return QByteArray();
+        }
+        QByteArray buffer = std::move(free_.back());
+        free_.pop_back();
+        return buffer;
+    }
+    
+    void give(QByteArray buffer) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        free_.push_back(std::move(buffer));
+    }
+    
+private:
+    std::mutex mutex_;
+    std::vector<QByteArray> free_;
+};
+
+// Image waiting in its target format's queue for a mogrify run
+struct QueuedImage {
+    std::size_t index;
+    ConversionRecord record;
+    std::string cacheKey;
+};
+
+// Reads a whole file into 'buffer', reusing its allocation when large enough.
+// Fails for files larger than kMaxPipelinedImageBytes.
+bool readWholeFile(const std::string& path, QByteArray& buffer) {
+    QFile file(QString::fromStdString(path));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    qint64 size = file.size();
+    if (size < 0 || static_cast<std::uint64_t>(size) > kMaxPipelinedImageBytes) {
+        return false;
+    }
+    buffer.resize(static_cast<int>(size));
+    return file.read(buffer.data(), size) == size;
+}
+
+// Splits jobs into runs of a tool that names its outputs after the inputs: one
+// run must not contain two inputs with the same base name, nor more than maxPerRun
+std::vector<std::vector<std::size_t>> splitIntoRuns(const std::vector<ConversionJob>& jobs,
+                                                    const std::vector<std::size_t>& indices, std::size_t maxPerRun) {
+    std::vector<std::vector<std::size_t>> runs;
+    std::vector<std::set<QString>> runNames;
+    for (std::size_t index : indices) {
+        QString baseName = QFileInfo(QString::fromStdString(jobs[index].inputFile)).completeBaseName();
+        std::size_t run = 0;
+        while (run < runs.size() && (runs[run].size() >= maxPerRun || runNames[run].count(baseName) > 0)) {
+            ++run;
+        }
+        if (run == runs.size()) {
+            runs.emplace_back();
+            runNames.emplace_back();
+        }
+        runs[run].push_back(index);
+        runNames[run].insert(baseName);
+    }
+    return runs;
+}
+
+// Moves LibreOffice's output (named after the input) to the requested path
+bool moveOfficeOutput(const QString& producedFile, const QString& outputFile) {
+    // If the produced file already has the requested path there is nothing to do
+    if (producedFile == outputFile) {
+        return true;
+    }
+    
+    // Remove existing output file if it exists
+    if (QFile::exists(outputFile)) {
+        QFile::remove(outputFile);
+    }
+    
+    // Rename the file
+    bool renameSuccess = QFile::rename(producedFile, outputFile);
+    std::cout << "File rename result: " << (renameSuccess ? "success" : "failed") << std::endl;
+    return renameSuccess;
+}
+
+// Pandoc reader/writer name for a text format
+QString pandocFormat(FileFormat format) {
+    switch (format) {
+        case FileFormat::TXT: return "plain";
+        case FileFormat::CSV: return "csv";
+        case FileFormat::JSON: return "json";
+        case FileFormat::XML: return "xml";
+        case FileFormat::HTML: return "html";
+        case FileFormat::MD: return "markdown";
+        default: return "plain";
+    }
+}
+
+} // namespace
+
 // Specific converter implementations
 class TxtToCsvConverter : public FormatConverter {
 public:
     bool convert(const std::string& inputFile, const std::string& outputFile) override {
-        std::ifstream input(inputFile);
-        std::ofstream output(outputFile);
-        
-        if (!input || !output) {
-            std::cerr << "Error opening files!" << std::endl;
+        // Simple conversion: replace spaces with commas
+        return translateFile(inputFile, outputFile, ' ', ',');
+    }
+};
+
+class CsvToTxtConverter : public FormatConverter {
+public:
+    bool convert(const std::string& inputFile, const std::string& outputFile) override {
+        return convertWithThreads(inputFile, outputFile, 0);
+    }
+    
+    bool convertWithThreads(const std::string& inputFile, const std::string& outputFile,
+                            std::size_t threads) override {
+        // Delimiters become spaces; quoted fields are unquoted, chunks run in parallel
+        return csvToTextFile(inputFile, outputFile, threads);
+    }
+};
+
+class JsonToTxtConverter : public FormatConverter {
+public:
+    bool convert(const std::string& inputFile, const std::string& outputFile) override {
+        std::string error;
+        if (!renderJsonTextFile(inputFile, outputFile, &error)) {
+            std::cerr << "JSON to TXT conversion failed: " << error << std::endl;
             return false;
         }
-        
-        std::string line;
-        while (std::getline(input, line)) {
-            // Simple conversion: replace spaces with commas
-            std::replace(line.begin(), line.end(), ' ', ',');
-            output << line << std::endl;
-        }
-        
         return true;
     }
 };
 
-class CsvToTxtConverter : public FormatConverter {
+// Raster images decoded and encoded through Qt's image plugins
+class QtImageConverter : public FormatConverter {
 public:
+    explicit QtImageConverter(FileFormat outputFormat) : outputFormat_(outputFormat) {}
+    
     bool convert(const std::string& inputFile, const std::string& outputFile) override {
-        std::ifstream input(inputFile);
-        std::ofstream output(outputFile);
-        
-        if (!input || !output) {
-            std::cerr << "Error opening files!" << std::endl;
+        std::string error;
+        if (!convertImageFile(inputFile, outputFile, outputFormat_, &error)) {
+            std::cerr << "Image conversion failed: " << error << std::endl;
             return false;
         }
-        
-        std::string line;
-        while (std::getline(input, line)) {
-            // Simple conversion: replace commas with spaces
-            std::replace(line.begin(), line.end(), ',', ' ');
-            output << line << std::endl;
+        return true;
+    }
+    
+    // Animations and oversized icons are left to ImageMagick
+    bool accepts(const std::string& inputFile) const override {
+        return qtAcceptsImage(inputFile, outputFormat_);
+    }
+    
+private:
+    FileFormat outputFormat_;
+};
+
+// CSV, JSON and XML conversions implemented in StructuredData
+class StructuredDataConverter : public FormatConverter {
+public:
+    using Function = bool (*)(const std::string& inputPath, const std::string& outputPath, std::string* error);
+    
+    explicit StructuredDataConverter(Function function) : function_(function) {}
+    
+    bool convert(const std::string& inputFile, const std::string& outputFile) override {
+        std::string error;
+        if (!function_(inputFile, outputFile, &error)) {
+            std::cerr << "Conversion failed: " << error << std::endl;
+            return false;
         }
-        
         return true;
     }
+    
+private:
+    Function function_;
 };
 
 // FileConverter implementation
@@ -70,356 +287,1098 @@ void FileConverter::initConverters() {
     // Add converters for different format pairs
     converters_[{FileFormat::TXT, FileFormat::CSV}] = std::make_unique<TxtToCsvConverter>();
     converters_[{FileFormat::CSV, FileFormat::TXT}] = std::make_unique<CsvToTxtConverter>();
+    converters_[{FileFormat::JSON, FileFormat::TXT}] = std::make_unique<JsonToTxtConverter>();
+    converters_[{FileFormat::CSV, FileFormat::JSON}] = std::make_unique<StructuredDataConverter>(convertCsvToJson);
+    converters_[{FileFormat::JSON, FileFormat::CSV}] = std::make_unique<StructuredDataConverter>(convertJsonToCsv);
+    converters_[{FileFormat::CSV, FileFormat::XML}] = std::make_unique<StructuredDataConverter>(convertCsvToXml);
+    converters_[{FileFormat::XML, FileFormat::CSV}] = std::make_unique<StructuredDataConverter>(convertXmlToCsv);
+    converters_[{FileFormat::JSON, FileFormat::XML}] = std::make_unique<StructuredDataConverter>(convertJsonToXml);
+    converters_[{FileFormat::XML, FileFormat::JSON}] = std::make_unique<StructuredDataConverter>(convertXmlToJson);
+    
+    // Raster pairs the installed Qt image plugins can read and write
+    for (std::size_t in = 0; in < kFormatCount; ++in) {
+        for (std::size_t out = 0; out < kFormatCount; ++out) {
+            FileFormat input = static_cast<FileFormat>(in);
+            FileFormat output = static_cast<FileFormat>(out);
+            if (in != out && categoryOf(input) == FormatCategory::IMAGE && categoryOf(output) == FormatCategory::IMAGE &&
+                qtCanConvertImage(input, output)) {
+                converters_[{input, output}] = std::make_unique<QtImageConverter>(output);
+            }
+        }
+    }
     
     // Add more converters as needed
 }
 
 bool FileConverter::convert(const std::string& inputFile, const std::string& outputFile) {
-    FileFormat inputFormat = detectFormat(inputFile);
+    ConversionRecord record;
+    bool success;
+    {
+        RecordScope scope(record);
+        success = runConversion(inputFile, outputFile, record);
+    }
+    
+    finishRecord(record, inputFile, outputFile, success);
+    return success;
+}
+
+bool FileConverter::runConversion(const std::string& inputFile, const std::string& outputFile,
+                                  ConversionRecord& record) {
+    PhaseTimer probe(Phase::PROBE);
+    FileFormat inputFormat = detectInputFormat(inputFile);
     FileFormat outputFormat = detectFormat(outputFile);
+    record.from = formatLabel(inputFormat);
+    record.to = formatLabel(outputFormat);
+    record.engine = backendName(Backend::NONE);
     
     if (inputFormat == FileFormat::UNKNOWN || outputFormat == FileFormat::UNKNOWN) {
         std::cerr << "Unknown file format!" << std::endl;
+        noteFailure(FailureReason::UNSUPPORTED);
         return false;
     }
     
-    // Text format conversions
-    if ((inputFormat == FileFormat::TXT || inputFormat == FileFormat::CSV || 
-         inputFormat == FileFormat::JSON || inputFormat == FileFormat::XML ||
-         inputFormat == FileFormat::HTML || inputFormat == FileFormat::MD) &&
-        (outputFormat == FileFormat::TXT || outputFormat == FileFormat::CSV || 
-         outputFormat == FileFormat::JSON || outputFormat == FileFormat::XML ||
-         outputFormat == FileFormat::HTML || outputFormat == FileFormat::MD)) {
-        
-        // JSON to TXT conversion
-        if (inputFormat == FileFormat::JSON && outputFormat == FileFormat::TXT) {
-            return convertJsonToTxt(inputFile, outputFile);
-        }
-        
-        // Use Pandoc for text format conversions
-        QProcess process;
-        QStringList args;
-        
-        // Check if Pandoc is available
-        process.start("pandoc", QStringList() << "--version");
-        process.waitForFinished();
-        if (process.exitCode() != 0) {
-            std::cerr << "Pandoc is not installed!" << std::endl;
+    Backend backend = routeFor(inputFormat, outputFormat);
+    bool native = usesNativeConverter(inputFormat, outputFormat, backend, inputFile);
+    record.engine = backendName(native ? Backend::NATIVE : backend);
+    if (!native && backendTool(backend) == nullptr) {
+        std::cerr << "Conversion not supported!" << std::endl;
+        noteFailure(FailureReason::UNSUPPORTED);
+        return false;
+    }
+    
+    // The same content converted the same way before: reuse that result
+    std::string cacheKey = cacheKeyFor(inputFile, inputFormat, outputFormat, backend, native);
+    probe.stop();
+    if (fetchCached(cacheKey, outputFile)) {
+        return true;
+    }
+    
+    // Container-only changes copy the encoded streams instead of re-encoding
+    // them. Probed only on a cache miss, since the key does not depend on it.
+    bool streamCopy = false;
+    if (!native && backend == Backend::FFMPEG && isToolAvailable(backendTool(backend))) {
+        PhaseTimer probeStreams(Phase::PROBE);
+        streamCopy = probeStreamCopy(inputFile, inputFormat, outputFormat);
+        if (isCancelled()) {
+            noteFailure(FailureReason::CANCELLED);
             return false;
         }
-        
-        // Determine input format for Pandoc
-        QString inFormat;
-        switch (inputFormat) {
-            case FileFormat::TXT: inFormat = "plain"; break;
-            case FileFormat::CSV: inFormat = "csv"; break;
-            case FileFormat::JSON: inFormat = "json"; break;
-            case FileFormat::XML: inFormat = "xml"; break;
-            case FileFormat::HTML: inFormat = "html"; break;
-            case FileFormat::MD: inFormat = "markdown"; break;
-            default: inFormat = "plain";
+    }
+    if (streamCopy) {
+        record.engine = kStreamCopyEngine;
+    }
+    
+    // Wait for this conversion's share of the cores and hold it while it runs
+    std::unique_ptr<ResourceScheduler::Lease> lease = acquireLease(
+        streamCopy ? CostClass::LIGHT : costClassFor(native ? Backend::NATIVE : backend, outputFormat));
+    if (lease && isCancelled()) {
+        noteFailure(FailureReason::CANCELLED);
+        return false;
+    }
+    std::size_t threads = lease ? lease->threads() : 0;
+    
+    bool success;
+    if (native) {
+        PhaseTimer run(Phase::RUN);
+        success = converters_.at({inputFormat, outputFormat})->convertWithThreads(inputFile, outputFile, threads);
+        if (!success) {
+            noteFailure(FailureReason::CONVERTER_ERROR);
         }
-        
-        // Determine output format for Pandoc
-        QString outFormat;
-        switch (outputFormat) {
-            case FileFormat::TXT: outFormat = "plain"; break;
-            case FileFormat::CSV: outFormat = "csv"; break;
-            case FileFormat::JSON: outFormat = "json"; break;
-            case FileFormat::XML: outFormat = "xml"; break;
-            case FileFormat::HTML: outFormat = "html"; break;
-            case FileFormat::MD: outFormat = "markdown"; break;
-            default: outFormat = "plain";
+    } else {
+        success = false;
+        bool encode = !streamCopy;
+        if (streamCopy) {
+            success = convertWithFfmpeg(inputFile, outputFile, 0, true);
+            encode = !success && !isCancelled();
         }
-        
-        args << QString::fromStdString(inputFile)
-             << "-f" << inFormat
-             << "-t" << outFormat
-             << "-o" << QString::fromStdString(outputFile);
-        
-        process.start("pandoc", args);
-        process.waitForFinished();
-        
-        return (process.exitCode() == 0);
-    }
-    
-    // Image format conversions
-    else if ((inputFormat == FileFormat::JPG || inputFormat == FileFormat::PNG || 
-              inputFormat == FileFormat::GIF || inputFormat == FileFormat::BMP ||
-              inputFormat == FileFormat::TIFF || inputFormat == FileFormat::WEBP ||
-              inputFormat == FileFormat::SVG || inputFormat == FileFormat::ICO) &&
-             (outputFormat == FileFormat::JPG || outputFormat == FileFormat::PNG || 
-              outputFormat == FileFormat::GIF || outputFormat == FileFormat::BMP ||
-              outputFormat == FileFormat::TIFF || outputFormat == FileFormat::WEBP ||
-              outputFormat == FileFormat::SVG || outputFormat == FileFormat::ICO)) {
-        
-        // Use ImageMagick for image conversions
-        QProcess process;
-        
-        // Check if ImageMagick is available
-        process.start("magick", QStringList() << "-version");
-        process.waitForFinished();
-        if (process.exitCode() != 0) {
-            std::cerr << "ImageMagick is not installed!" << std::endl;
-            return false;
+        if (encode && streamCopy) {
+            // The streams did not fit after all (e.g. timestamps the container
+            // cannot store); encode them, with the budget of an encode
+            std::cerr << "Stream copy failed, re-encoding: " << inputFile << std::endl;
+            record.engine = backendName(backend);
+            record.failure = FailureReason::NONE;
+            if (lease) {
+                lease.reset();
+                lease = acquireLease(costClassFor(backend, outputFormat));
+                threads = lease->threads();
+            }
+        }
+        if (encode) {
+            // Tool failures note their cause; what is left is a non-zero exit code
+            success = convertWithBackend(backend, inputFile, outputFile, inputFormat, outputFormat, threads);
+        }
+        if (!success) {
+            noteFailure(FailureReason::EXIT_CODE);
         }
-        
-        QStringList args;
-        args << "convert"
-             << QString::fromStdString(inputFile)
-             << QString::fromStdString(outputFile);
-        
-        process.start("magick", args);
-        process.waitForFinished();
-        
-        return (process.exitCode() == 0);
     }
     
-    // Audio format conversions
-    else if ((inputFormat == FileFormat::MP3 || inputFormat == FileFormat::WAV || 
-              inputFormat == FileFormat::AAC || inputFormat == FileFormat::FLAC ||
-              inputFormat == FileFormat::OGG || inputFormat == FileFormat::WMA) &&
-             (outputFormat == FileFormat::MP3 || outputFormat == FileFormat::WAV || 
-              outputFormat == FileFormat::AAC || outputFormat == FileFormat::FLAC ||
-              outputFormat == FileFormat::OGG || outputFormat == FileFormat::WMA)) {
-        
-        // Use FFmpeg for audio conversions
-        QProcess process;
-        
-        // Check if FFmpeg is available
-        process.start("ffmpeg", QStringList() << "-version");
-        process.waitForFinished();
-        if (process.exitCode() != 0) {
-            std::cerr << "FFmpeg is not installed!" << std::endl;
+    if (success) {
+        storeCached(cacheKey, outputFile);
+    }
+    return success;
+}
+
+std::string FileConverter::cacheKeyFor(const std::string& inputFile, FileFormat inputFormat, FileFormat outputFormat,
+                                       Backend backend, bool native) const {
+    if (!cache_) {
+        return std::string();
+    }
+    return cache_->makeKey(inputFile, getExtension(outputFormat),
+                           cacheParameters(inputFormat, outputFormat, backend, native));
+}
+
+bool FileConverter::fetchCached(const std::string& cacheKey, const std::string& outputFile) {
+    if (cacheKey.empty()) {
+        return false;
+    }
+    PhaseTimer copy(Phase::RENAME);
+    if (cache_->fetch(cacheKey, outputFile)) {
+        if (activeRecord) {
+            activeRecord->engine = "cache";
+        }
+        return true;
+    }
+    // An earlier hit may have left a hard link to a cache entry here; writing
+    // through it would change the entry
+    QFile::remove(QString::fromStdString(outputFile));
+    return false;
+}
+
+void FileConverter::storeCached(const std::string& cacheKey, const std::string& outputFile) {
+    if (!cacheKey.empty()) {
+        PhaseTimer copy(Phase::RENAME);
+        cache_->store(cacheKey, outputFile);
+    }
+}
+
+std::unique_ptr<ResourceScheduler::Lease> FileConverter::acquireLease(CostClass cost) {
+    if (!scheduler_) {
+        return nullptr;
+    }
+    PhaseTimer wait(Phase::WAIT);
+    return std::make_unique<ResourceScheduler::Lease>(scheduler_->acquire(cost));
+}
+
+void FileConverter::finishRecord(ConversionRecord& record, const std::string& inputFile,
+                                 const std::string& outputFile, bool success) {
+    record.success = success;
+    record.bytesIn = fileSize(inputFile);
+    if (success) {
+        record.bytesOut = fileSize(outputFile);
+    }
+    metrics_.record(record);
+}
+
+bool FileConverter::usesNativeConverter(FileFormat inputFormat, FileFormat outputFormat, Backend backend,
+                                        const std::string& inputFile) const {
+    auto converter = converters_.find({inputFormat, outputFormat});
+    if (converter == converters_.end()) {
+        return false;
+    }
+    const char* tool = backendTool(backend);
+    if (tool == nullptr || !isToolAvailable(tool)) {
+        return true;
+    }
+    return enginePreference(inputFormat, outputFormat) == Engine::NATIVE &&
+           (inputFile.empty() || converter->second->accepts(inputFile));
+}
+
+bool FileConverter::convertWithBackend(Backend backend, const std::string& inputFile, const std::string& outputFile,
+                                       FileFormat inputFormat, FileFormat outputFormat, std::size_t threads) {
+    // One table lookup picks the backend for the pair
+    switch (backend) {
+        case Backend::PANDOC:
+            return convertWithPandoc(inputFile, outputFile, inputFormat, outputFormat);
+        case Backend::IMAGEMAGICK:
+            return convertWithImageMagick(inputFile, outputFile, threads);
+        case Backend::FFMPEG:
+            return convertWithFfmpeg(inputFile, outputFile, threads);
+        case Backend::LIBREOFFICE:
+            return convertWithLibreOffice(inputFile, outputFile, inputFormat, outputFormat);
+        case Backend::NATIVE:
+        case Backend::NONE:
+            break;
+    }
+    
+    std::cerr << "Conversion not supported!" << std::endl;
+    return false;
+}
+
+std::string FileConverter::cacheParameters(FileFormat inputFormat, FileFormat outputFormat,
+                                           Backend backend, bool native) const {
+    std::string parameters = std::to_string(formatIndex(inputFormat)) + '>' + std::to_string(formatIndex(outputFormat));
+    if (native) {
+        return parameters + " native " + std::to_string(kNativeEngineVersion);
+    }
+    // The version line of the tool, so upgrading it invalidates its results
+    ToolInfo tool = getToolInfo(backendTool(backend));
+    return parameters + ' ' + tool.name + ' ' + tool.version;
+}
+
+bool FileConverter::setCache(const std::string& directory, std::uint64_t maxBytes, bool hardLinks) {
+    if (directory.empty()) {
+        cache_.reset();
+        return true;
+    }
+    auto cache = std::make_unique<ConversionCache>(directory, maxBytes);
+    if (!cache->isValid()) {
+        std::cerr << "Cannot use cache directory " << directory << std::endl;
+        return false;
+    }
+    cache->setHardLinks(hardLinks);
+    cache_ = std::move(cache);
+    return true;
+}
+
+ConversionCache::Stats FileConverter::cacheStats() const {
+    return cache_ ? cache_->stats() : ConversionCache::Stats();
+}
+
+void FileConverter::setCpuBudget(std::size_t cores) {
+    scheduler_ = cores > 0 ? std::make_unique<ResourceScheduler>(cores) : nullptr;
+}
+
+std::size_t FileConverter::cpuBudget() const {
+    return scheduler_ ? scheduler_->cores() : 0;
+}
+
+bool FileConverter::convertWithPandoc(const std::string& inputFile, const std::string& outputFile,
+                                      FileFormat inputFormat, FileFormat outputFormat) {
+    // Use Pandoc for text format conversions
+    ToolInfo pandoc = getToolInfo("pandoc");
+    if (!pandoc.available) {
+        std::cerr << "Pandoc is not installed!" << std::endl;
+        noteFailure(FailureReason::TOOL_MISSING);
+        return false;
+    }
+    
+    QProcess process;
+    QStringList args;
+    args << QString::fromStdString(inputFile)
+         << "-f" << pandocFormat(inputFormat)
+         << "-t" << pandocFormat(outputFormat)
+         << "-o" << QString::fromStdString(outputFile);
+    
+    return runProcess(process, QString::fromStdString(pandoc.path), args) && process.exitCode() == 0;
+}
+
+bool FileConverter::convertWithImageMagick(const std::string& inputFile, const std::string& outputFile,
+                                           std::size_t threads) {
+    ToolInfo magick = getToolInfo("magick");
+    if (!magick.available) {
+        std::cerr << "ImageMagick is not installed!" << std::endl;
+        noteFailure(FailureReason::TOOL_MISSING);
+        return false;
+    }
+    
+    QProcess process;
+    QStringList args;
+    args << "convert";
+    if (threads > 0) {
+        args << "-limit" << "thread" << QString::number(static_cast<int>(threads));
+    }
+    args << QString::fromStdString(inputFile)
+         << QString::fromStdString(outputFile);
+    
+    return runProcess(process, QString::fromStdString(magick.path), args) && process.exitCode() == 0;
+}
+
+void FileConverter::setEnginePreference(FileFormat inputFormat, FileFormat outputFormat, Engine engine) {
+    enginePreferences_[{inputFormat, outputFormat}] = engine;
+}
+
+Engine FileConverter::enginePreference(FileFormat inputFormat, FileFormat outputFormat) const {
+    auto it = enginePreferences_.find({inputFormat, outputFormat});
+    if (it != enginePreferences_.end()) {
+        return it->second;
+    }
+    
+    // In-process converters skip the process start and the tool's own startup,
+    // which dominate small files; Pandoc also has no CSV writer and its JSON
+    // reader and writer only handle its own document AST
+    return Engine::NATIVE;
+}
+
+bool FileConverter::hasNativeConverter(FileFormat inputFormat, FileFormat outputFormat) const {
+    return converters_.count({inputFormat, outputFormat}) > 0;
+}
+
+RoutePlan FileConverter::explain(FileFormat inputFormat, FileFormat outputFormat) const {
+    return planRoute(inputFormat, outputFormat, std::string());
+}
+
+RoutePlan FileConverter::explain(const std::string& inputFile, const std::string& outputFile) const {
+    return planRoute(detectInputFormat(inputFile), detectFormat(outputFile), inputFile);
+}
+
+RoutePlan FileConverter::planRoute(FileFormat inputFormat, FileFormat outputFormat,
+                                   const std::string& inputFile) const {
+    RoutePlan plan;
+    if (inputFormat == FileFormat::UNKNOWN || outputFormat == FileFormat::UNKNOWN) {
+        plan.reason = "unknown format";
+        return plan;
+    }
+    
+    // Same decision as convert()
+    Backend backend = routeFor(inputFormat, outputFormat);
+    const char* tool = backendTool(backend);
+    bool native = usesNativeConverter(inputFormat, outputFormat, backend, inputFile);
+    if (native) {
+        plan.engine = Backend::NATIVE;
+        plan.available = true;
+        if (tool == nullptr) {
+            plan.reason = "in-process converter, no external tool serves the pair";
+        } else if (enginePreference(inputFormat, outputFormat) == Engine::NATIVE) {
+            plan.reason = std::string("in-process converter preferred over ") + backendName(backend);
+        } else {
+            plan.reason = std::string("in-process converter, ") + backendName(backend) + " is not installed";
+        }
+    } else if (tool != nullptr) {
+        plan.engine = backend;
+        plan.available = isToolAvailable(tool);
+        plan.processes = 1;
+        if (!hasNativeConverter(inputFormat, outputFormat)) {
+            plan.reason = std::string(backendName(backend)) + ", no in-process converter for the pair";
+        } else if (enginePreference(inputFormat, outputFormat) == Engine::EXTERNAL) {
+            plan.reason = std::string(backendName(backend)) + " preferred over the in-process converter";
+        } else {
+            plan.reason = std::string(backendName(backend)) + ", the in-process converter declines this file";
+        }
+        if (!plan.available) {
+            plan.reason += std::string("; ") + tool + " is not installed";
+        }
+    } else {
+        plan.reason = "no conversion route";
+        return plan;
+    }
+    
+    // Only a given file tells whether its streams can be copied
+    bool streamCopy = false;
+    if (!inputFile.empty() && plan.engine == Backend::FFMPEG && plan.available) {
+        std::string encodeReason;
+        streamCopy = probeStreamCopy(inputFile, inputFormat, outputFormat, &encodeReason);
+        if (streamCopy) {
+            plan.reason += "; streams copied into the new container without re-encoding";
+        } else if (!encodeReason.empty()) {
+            plan.reason += "; re-encoding, " + encodeReason;
+        }
+    }
+    
+    // convert() runs ffprobe ahead of FFmpeg whenever the pair might copy
+    if (plan.engine == Backend::FFMPEG && plan.available && mayStreamCopy(inputFormat, outputFormat) &&
+        isToolAvailable("ffprobe")) {
+        plan.processes = 2;
+    }
+    
+    plan.cost = streamCopy ? CostClass::LIGHT : costClassFor(plan.engine, outputFormat);
+    if (scheduler_ && plan.engine != Backend::NATIVE) {
+        plan.threads = scheduler_->threadBudget(plan.cost);
+    }
+    
+    std::string from = getExtension(inputFormat).substr(1);
+    std::string to = getExtension(outputFormat).substr(1);
+    RouteMetrics route = metrics_.route(
+        ConversionMetrics::RouteKey(from, to, streamCopy ? kStreamCopyEngine : backendName(plan.engine)));
+    if (route.total.count() > 0) {
+        plan.expectedSeconds = route.total.sum() / static_cast<double>(route.total.count());
+    }
+    return plan;
+}
+
+ToolInfo FileConverter::getToolInfo(const std::string& tool) const {
+    return ToolRegistry::instance().lookup(tool);
+}
+
+bool FileConverter::isToolAvailable(const std::string& tool) const {
+    return ToolRegistry::instance().isAvailable(tool);
+}
+
+void FileConverter::cancel() {
+    cancelled_ = true;
+}
+
+void FileConverter::resetCancel() {
+    cancelled_ = false;
+}
+
+bool FileConverter::isCancelled() const {
+    return cancelled_;
+}
+
+void FileConverter::setOfficeWorkers(std::size_t count) {
+    std::lock_guard<std::mutex> lock(officePoolMutex_);
+    officeWorkerCount_ = count;
+    officePool_.reset();
+}
+
+std::size_t FileConverter::officeWorkers() const {
+    std::lock_guard<std::mutex> lock(officePoolMutex_);
+    return officeWorkerCount_;
+}
+
+OfficeWorkerPool* FileConverter::officePool(const std::string& sofficePath) {
+    std::lock_guard<std::mutex> lock(officePoolMutex_);
+    if (officeWorkerCount_ == 0) {
+        return nullptr;
+    }
+    if (!officePool_) {
+        officePool_ = std::make_unique<OfficeWorkerPool>(sofficePath, officeWorkerCount_);
+    }
+    return officePool_.get();
+}
+
+void FileConverter::setProgressCallback(ProgressCallback callback) {
+    progressCallback_ = std::move(callback);
+}
+
+bool FileConverter::runProcess(QProcess& process, const QString& program, const QStringList& args,
+                               const std::function<void()>& onPoll) {
+    {
+        PhaseTimer spawn(Phase::SPAWN);
+        process.start(program, args);
+        if (!process.waitForStarted()) {
+            std::cerr << "Failed to start " << program.toStdString() << std::endl;
+            noteFailure(FailureReason::START_FAILED);
             return false;
         }
-        
-        QStringList args;
-        args << "-i" << QString::fromStdString(inputFile)
-             << "-y" // Overwrite output file if it exists
-             << QString::fromStdString(outputFile);
-        
-        process.start("ffmpeg", args);
-        process.waitForFinished();
-        
-        return (process.exitCode() == 0);
-    }
-    
-    // Video format conversions
-    else if ((inputFormat == FileFormat::MP4 || inputFormat == FileFormat::AVI || 
-              inputFormat == FileFormat::MOV || inputFormat == FileFormat::MKV ||
-              inputFormat == FileFormat::WMV || inputFormat == FileFormat::FLV ||
-              inputFormat == FileFormat::WEBM || inputFormat == FileFormat::M4V) &&
-             (outputFormat == FileFormat::MP4 || outputFormat == FileFormat::AVI || 
-              outputFormat == FileFormat::MOV || outputFormat == FileFormat::MKV ||
-              outputFormat == FileFormat::WMV || outputFormat == FileFormat::FLV ||
-              outputFormat == FileFormat::WEBM || outputFormat == FileFormat::M4V)) {
-        
-        // Use FFmpeg for video conversions
-        QProcess process;
-        
-        // Check if FFmpeg is available
-        process.start("ffmpeg", QStringList() << "-version");
-        process.waitForFinished();
-        if (process.exitCode() != 0) {
-            std::cerr << "FFmpeg is not installed!" << std::endl;
+    }
+    
+    PhaseTimer run(Phase::RUN);
+    
+    // Poll rather than block so a cancel request kills the tool promptly
+    while (!process.waitForFinished(kCancelPollIntervalMs)) {
+        if (onPoll) {
+            onPoll();
+        }
+        if (process.state() == QProcess::NotRunning) {
+            break;
+        }
+        if (cancelled_) {
+            process.kill();
+            process.waitForFinished();
+            std::cerr << "Conversion cancelled" << std::endl;
+            noteFailure(FailureReason::CANCELLED);
             return false;
         }
-        
-        QStringList args;
-        args << "-i" << QString::fromStdString(inputFile)
-             << "-y" // Overwrite output file if it exists
-             << QString::fromStdString(outputFile);
-        
-        process.start("ffmpeg", args);
-        process.waitForFinished();
-        
-        return (process.exitCode() == 0);
     }
     
-    // Document format conversions
-    else if ((inputFormat == FileFormat::PDF || inputFormat == FileFormat::DOCX ||
-              inputFormat == FileFormat::ODT || inputFormat == FileFormat::RTF) &&
-             (outputFormat == FileFormat::PDF || outputFormat == FileFormat::DOCX ||
-              outputFormat == FileFormat::ODT || outputFormat == FileFormat::RTF)) {
-        
-        // Use LibreOffice for document conversions
-        QProcess process;
-        QString libreOfficePath = "soffice"; // You have LibreOffice in your PATH
-        
-        // Get file paths
-        QFileInfo inputFileInfo(QString::fromStdString(inputFile));
-        QFileInfo outputFileInfo(QString::fromStdString(outputFile));
-        QString outputDir = outputFileInfo.absolutePath();
-        
-        // Debug output
-        std::cout << "Converting document: " << inputFile << " to " << outputFile << std::endl;
-        std::cout << "Input format: " << static_cast<int>(inputFormat) << ", Output format: " << static_cast<int>(outputFormat) << std::endl;
-        
+    // Deliver whatever output arrived after the last poll
+    if (onPoll) {
+        onPoll();
+    }
+    
+    if (process.exitStatus() != QProcess::NormalExit) {
+        noteFailure(FailureReason::CRASHED);
+        return false;
+    }
+    return true;
+}
+
+bool FileConverter::convertWithLibreOffice(const std::string& inputFile, const std::string& outputFile,
+                                           FileFormat inputFormat, FileFormat outputFormat) {
+    ToolInfo soffice = getToolInfo("soffice");
+    if (!soffice.available) {
+        std::cerr << "LibreOffice is not installed!" << std::endl;
+        noteFailure(FailureReason::TOOL_MISSING);
+        return false;
+    }
+    
+    QProcess process;
+    QString libreOfficePath = QString::fromStdString(soffice.path);
+    
+    // Get file paths
+    QFileInfo inputFileInfo(QString::fromStdString(inputFile));
+    QFileInfo outputFileInfo(QString::fromStdString(outputFile));
+    QString outputDir = outputFileInfo.absolutePath();
+    
+    // Debug output
+    std::cout << "Converting document: " << inputFile << " to " << outputFile << std::endl;
+    std::cout << "Input format: " << static_cast<int>(inputFormat) << ", Output format: " << static_cast<int>(outputFormat) << std::endl;
+    
+    // Conversion attempts in order; PDF to DOCX needs the Writer PDF import filter
+    // and falls back to naming the filter in --convert-to
+    std::vector<QStringList> attempts;
+    if (inputFormat == FileFormat::PDF && outputFormat == FileFormat::DOCX) {
+        std::cout << "Using special PDF to DOCX conversion..." << std::endl;
+        attempts.push_back(QStringList() << "--infilter=writer_pdf_import" << "--convert-to" << "docx");
+        attempts.push_back(QStringList() << "--convert-to" << "docx:writer_pdf_import");
+    } else {
+        attempts.push_back(QStringList() << "--convert-to" << QString::fromStdString(getExtension(outputFormat).substr(1)));
+    }
+    
+    // LibreOffice creates the output file with the same name as input but different extension
+    QString expectedOutput = QDir(outputDir).filePath(
+        inputFileInfo.completeBaseName() + QString::fromStdString(getExtension(outputFormat)));
+    
+    // Route the conversion to a warm instance when the worker pool is enabled
+    std::unique_ptr<OfficeWorkerPool::Lease> worker;
+    if (OfficeWorkerPool* pool = officePool(soffice.path)) {
+        worker = std::make_unique<OfficeWorkerPool::Lease>(pool->acquire());
+    }
+    
+    bool retriedAfterCrash = false;
+    std::size_t attempt = 0;
+    while (attempt < attempts.size()) {
         QStringList args;
-        
-        // Special handling for PDF to DOCX conversion
-        if (inputFormat == FileFormat::PDF && outputFormat == FileFormat::DOCX) {
-            std::cout << "Using special PDF to DOCX conversion..." << std::endl;
-            
-            args << "--headless" 
-                 << "--infilter=writer_pdf_import" 
-                 << "--convert-to" << "docx" 
-                 << "--outdir" << outputDir
-                 << QString::fromStdString(inputFile);
-        } else {
-            // Standard conversion for other document formats
-            args << "--headless"
-                 << "--convert-to" << QString::fromStdString(getExtension(outputFormat).substr(1))
-                 << "--outdir" << outputDir
-                 << QString::fromStdString(inputFile);
+        if (worker) {
+            args << worker->arguments();
         }
+        args << "--headless"
+             << attempts[attempt]
+             << "--outdir" << outputDir
+             << QString::fromStdString(inputFile);
         
-        // Start the process with the found LibreOffice path
+        if (attempt > 0) {
+            std::cout << "First method failed, trying alternative approach..." << std::endl;
+        }
         std::cout << "Running LibreOffice with command: " << libreOfficePath.toStdString() << " " 
                   << args.join(" ").toStdString() << std::endl;
         
-        process.start(libreOfficePath, args);
-        process.waitForFinished(-1); // Wait indefinitely
+        runProcess(process, libreOfficePath, args);
+        if (isCancelled()) {
+            return false;
+        }
         
         // Debug output
         std::cout << "LibreOffice exit code: " << process.exitCode() << std::endl;
         std::cout << "LibreOffice stdout: " << process.readAllStandardOutput().toStdString() << std::endl;
         std::cout << "LibreOffice stderr: " << process.readAllStandardError().toStdString() << std::endl;
-        
-        // LibreOffice creates the output file with the same name as input but different extension
-        QString expectedOutput = QDir(outputDir).filePath(
-            inputFileInfo.completeBaseName() + QString::fromStdString(getExtension(outputFormat)));
-        
         std::cout << "Looking for output file: " << expectedOutput.toStdString() << std::endl;
         
-        // Check if the file exists
         if (QFile::exists(expectedOutput)) {
-            // If the expected output file exists and is different from the requested output path
-            if (expectedOutput != QString::fromStdString(outputFile)) {
-                // Remove existing output file if it exists
-                if (QFile::exists(QString::fromStdString(outputFile))) {
-                    QFile::remove(QString::fromStdString(outputFile));
+            PhaseTimer rename(Phase::RENAME);
+            return moveOfficeOutput(expectedOutput, QString::fromStdString(outputFile));
+        }
+        
+        // A crashed worker produces nothing: restart it and rerun the same attempt once
+        if (worker && !worker->isHealthy() && !retriedAfterCrash) {
+            retriedAfterCrash = true;
+            if (worker->restart()) {
+                continue;
+            }
+        }
+        ++attempt;
+    }
+    
+    std::cerr << "Output file not found after conversion!" << std::endl;
+    noteFailure(FailureReason::NO_OUTPUT);
+    return false;
+}
+
+std::vector<bool> FileConverter::convertDocuments(const std::vector<ConversionJob>& jobs) {
+    std::vector<bool> results(jobs.size(), false);
+    ToolInfo soffice = getToolInfo("soffice");
+    
+    // Group document jobs by target format (PDF input to DOCX also needs the import filter)
+    std::map<std::pair<FileFormat, bool>, std::vector<std::size_t>> groups;
+    std::vector<bool> batched(jobs.size(), false);
+    std::vector<std::string> cacheKeys(jobs.size());
+    // Measurements of the documents converted here; the rest are measured by convert()
+    std::vector<ConversionRecord> records(jobs.size());
+    
+    for (std::size_t i = 0; i < jobs.size(); ++i) {
+        RecordScope scope(records[i]);
+        PhaseTimer probe(Phase::PROBE);
+        FileFormat inputFormat = detectInputFormat(jobs[i].inputFile);
+        FileFormat outputFormat = detectFormat(jobs[i].outputFile);
+        records[i].from = formatLabel(inputFormat);
+        records[i].to = formatLabel(outputFormat);
+        records[i].engine = backendName(Backend::LIBREOFFICE);
+        
+        if (soffice.available && routeFor(inputFormat, outputFormat) == Backend::LIBREOFFICE) {
+            // Cached documents skip the batch entirely
+            cacheKeys[i] = cacheKeyFor(jobs[i].inputFile, inputFormat, outputFormat, Backend::LIBREOFFICE, false);
+            probe.stop();
+            if (fetchCached(cacheKeys[i], jobs[i].outputFile)) {
+                results[i] = true;
+                continue;
+            }
+            
+            bool pdfImport = (inputFormat == FileFormat::PDF && outputFormat == FileFormat::DOCX);
+            groups[{outputFormat, pdfImport}].push_back(i);
+            batched[i] = true;
+        }
+    }
+    
+    for (const auto& group : groups) {
+        // soffice names outputs after the input
+        for (const std::vector<std::size_t>& run : splitIntoRuns(jobs, group.second, kMaxDocumentsPerRun)) {
+            if (isCancelled()) {
+                return results;
+            }
+            runOfficeBatch(soffice, jobs, run, group.first.first, group.first.second, results, records);
+            for (std::size_t index : run) {
+                if (results[index]) {
+                    RecordScope scope(records[index]);
+                    storeCached(cacheKeys[index], jobs[index].outputFile);
                 }
-                
-                // Rename the file
-                bool renameSuccess = QFile::rename(expectedOutput, QString::fromStdString(outputFile));
-                std::cout << "File rename result: " << (renameSuccess ? "success" : "failed") << std::endl;
-                return renameSuccess;
             }
-            return true;
+        }
+    }
+    
+    for (std::size_t i = 0; i < jobs.size(); ++i) {
+        if (results[i]) {
+            finishRecord(records[i], jobs[i].inputFile, jobs[i].outputFile, true);
+        }
+    }
+    
+    // Non-document jobs, and documents the batch run could not produce, go one at a time
+    for (std::size_t i = 0; i < jobs.size(); ++i) {
+        if (isCancelled()) {
+            break;
+        }
+        if (!results[i]) {
+            if (batched[i]) {
+                std::cout << "Retrying individually: " << jobs[i].inputFile << std::endl;
+            }
+            results[i] = convert(jobs[i].inputFile, jobs[i].outputFile);
+        }
+    }
+    
+    return results;
+}
+
+void FileConverter::runOfficeBatch(const ToolInfo& soffice, const std::vector<ConversionJob>& jobs,
+                                   const std::vector<std::size_t>& run, FileFormat outputFormat,
+                                   bool pdfImport, std::vector<bool>& results,
+                                   std::vector<ConversionRecord>& records) {
+    // Convert into a private directory, then move each output to its requested name
+    QTemporaryDir outputDir(QDir(QDir::tempPath()).filePath("fileconverter-docs-XXXXXX"));
+    if (!outputDir.isValid()) {
+        std::cerr << "Cannot create temporary directory for document batch" << std::endl;
+        return;
+    }
+    
+    QString extension = QString::fromStdString(getExtension(outputFormat));
+    
+    // Phases of the whole run, shared out evenly between its documents below
+    ConversionRecord shared;
+    RecordScope scope(shared);
+    
+    std::unique_ptr<ResourceScheduler::Lease> lease = acquireLease(CostClass::MEDIUM);
+    
+    std::unique_ptr<OfficeWorkerPool::Lease> worker;
+    if (OfficeWorkerPool* pool = officePool(soffice.path)) {
+        worker = std::make_unique<OfficeWorkerPool::Lease>(pool->acquire());
+    }
+    
+    QStringList args;
+    if (worker) {
+        args << worker->arguments();
+    }
+    args << "--headless";
+    if (pdfImport) {
+        args << "--infilter=writer_pdf_import";
+    }
+    args << "--convert-to" << extension.mid(1)
+         << "--outdir" << outputDir.path();
+    for (std::size_t index : run) {
+        args << QString::fromStdString(jobs[index].inputFile);
+    }
+    
+    std::cout << "Converting " << run.size() << " documents to " << extension.toStdString()
+              << " in one LibreOffice run" << std::endl;
+    
+    QProcess process;
+    runProcess(process, QString::fromStdString(soffice.path), args);
+    if (isCancelled()) {
+        return;
+    }
+    
+    for (std::size_t index : run) {
+        ConversionRecord& record = records[index];
+        for (std::size_t phase = 0; phase < kPhaseCount; ++phase) {
+            if (shared.entered[phase]) {
+                record.addTime(static_cast<Phase>(phase), shared.seconds[phase] / static_cast<double>(run.size()));
+            }
         }
         
-        // Try alternative approach for PDF to DOCX if the first method failed
-        if (inputFormat == FileFormat::PDF && outputFormat == FileFormat::DOCX) {
-            std::cout << "First method failed, trying alternative approach..." << std::endl;
+        QString baseName = QFileInfo(QString::fromStdString(jobs[index].inputFile)).completeBaseName();
+        QString producedFile = QDir(outputDir.path()).filePath(baseName + extension);
+        if (QFile::exists(producedFile)) {
+            RecordScope documentScope(record);
+            PhaseTimer rename(Phase::RENAME);
+            results[index] = moveOfficeOutput(producedFile, QString::fromStdString(jobs[index].outputFile));
+        }
+    }
+}
+
+std::vector<bool> FileConverter::convertImages(const std::vector<ConversionJob>& jobs, std::size_t threads,
+                                               const ImageCallback& onFinished) {
+    std::vector<char> done(jobs.size(), 0);
+    std::mutex finishMutex;
+    auto finish = [&done, &finishMutex, &onFinished](std::size_t index, bool success, double seconds) {
+        std::lock_guard<std::mutex> lock(finishMutex);
+        done[index] = success ? 1 : 0;
+        if (onFinished) {
+            onFinished(index, success, seconds);
+        }
+    };
+    
+    BufferPool inputs;
+    ToolInfo magick = getToolInfo("magick");
+    // Images for ImageMagick, queued per target format until a mogrify run is full
+    std::map<FileFormat, std::vector<QueuedImage>> magickQueues;
+    {
+        // The bounded queue is what limits the inputs held in memory: reading
+        // stops while every worker is busy and 'threads' more inputs wait
+        std::size_t workers = threads > 0 ? threads : ThreadPool::defaultThreadCount();
+        ThreadPool pool(workers, workers);
+        
+        auto submitMagick = [this, &jobs, &finish, &magick, &pool](FileFormat outputFormat,
+                                                                  std::vector<QueuedImage>& queue) {
+            std::vector<std::size_t> indices;
+            std::map<std::size_t, QueuedImage*> queued;
+            for (QueuedImage& image : queue) {
+                indices.push_back(image.index);
+                queued[image.index] = &image;
+            }
+            // mogrify names its outputs after the inputs
+            for (const std::vector<std::size_t>& run : splitIntoRuns(jobs, indices, kMaxImagesPerRun)) {
+                std::vector<ConversionRecord> records;
+                std::vector<std::string> cacheKeys;
+                for (std::size_t index : run) {
+                    records.push_back(queued[index]->record);
+                    cacheKeys.push_back(queued[index]->cacheKey);
+                }
+                pool.submit([this, &jobs, &finish, &magick, outputFormat, run, records, cacheKeys]() mutable {
+                    auto start = std::chrono::steady_clock::now();
+                    std::vector<bool> produced(run.size(), false);
+                    runMagickBatch(magick, jobs, run, outputFormat, produced, records);
+                    // Time is shared by the whole run; report the per-image average
+                    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() /
+                                     static_cast<double>(run.size());
+                    
+                    for (std::size_t k = 0; k < run.size(); ++k) {
+                        const ConversionJob& job = jobs[run[k]];
+                        if (produced[k]) {
+                            {
+                                RecordScope scope(records[k]);
+                                storeCached(cacheKeys[k], job.outputFile);
+                            }
+                            finishRecord(records[k], job.inputFile, job.outputFile, true);
+                            finish(run[k], true, seconds);
+                        } else if (isCancelled()) {
+                            finish(run[k], false, seconds);
+                        } else {
+                            // Images the batched run could not produce go one at a time
+                            std::cout << "Retrying individually: " << job.inputFile << std::endl;
+                            auto retryStart = std::chrono::steady_clock::now();
+                            bool success = convert(job.inputFile, job.outputFile);
+                            finish(run[k], success, seconds + std::chrono::duration<double>(
+                                                                  std::chrono::steady_clock::now() - retryStart).count());
+                        }
+                    }
+                });
+            }
+            queue.clear();
+        };
+        
+        for (std::size_t i = 0; i < jobs.size(); ++i) {
+            if (isCancelled()) {
+                break;
+            }
+            const ConversionJob& job = jobs[i];
+            auto start = std::chrono::steady_clock::now();
+            
+            ConversionRecord record;
+            FileFormat outputFormat = detectFormat(job.outputFile);
+            std::string cacheKey;
+            bool pipelined;
+            bool queued;    // Converted by ImageMagick together with other images
+            {
+                RecordScope scope(record);
+                PhaseTimer probe(Phase::PROBE);
+                FileFormat inputFormat = detectInputFormat(job.inputFile);
+                Backend backend = routeFor(inputFormat, outputFormat);
+                pipelined = categoryOf(inputFormat) == FormatCategory::IMAGE &&
+                            categoryOf(outputFormat) == FormatCategory::IMAGE &&
+                            fileSize(job.inputFile) <= kMaxPipelinedImageBytes &&
+                            usesNativeConverter(inputFormat, outputFormat, backend, job.inputFile);
+                queued = !pipelined && backend == Backend::IMAGEMAGICK && magick.available;
+                record.from = formatLabel(inputFormat);
+                record.to = formatLabel(outputFormat);
+                record.engine = backendName(pipelined ? Backend::NATIVE : backend);
+                if (pipelined || queued) {
+                    cacheKey = cacheKeyFor(job.inputFile, inputFormat, outputFormat, backend, pipelined);
+                }
+            }
+            
+            if (!pipelined && !queued) {
+                pool.submit([this, &job, &finish, i] {
+                    auto start = std::chrono::steady_clock::now();
+                    bool success = convert(job.inputFile, job.outputFile);
+                    finish(i, success, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+                });
+                continue;
+            }
+            
+            bool hit;
+            {
+                RecordScope scope(record);
+                hit = fetchCached(cacheKey, job.outputFile);
+            }
+            if (hit) {
+                finishRecord(record, job.inputFile, job.outputFile, true);
+                finish(i, true, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+                continue;
+            }
             
-            // Clear previous arguments
-            args.clear();
-            args << "--headless"
-                 << "--convert-to" << "docx:writer_pdf_import" 
-                 << "--outdir" << outputDir
-                 << QString::fromStdString(inputFile);
-                 
-            process.start(libreOfficePath, args);
-            process.waitForFinished(-1);
+            if (queued) {
+                std::vector<QueuedImage>& queue = magickQueues[outputFormat];
+                queue.push_back({i, record, cacheKey});
+                if (queue.size() >= kMaxImagesPerRun) {
+                    submitMagick(outputFormat, queue);
+                }
+                continue;
+            }
             
-            std::cout << "Alternative method exit code: " << process.exitCode() << std::endl;
-            std::cout << "Alternative method stdout: " << process.readAllStandardOutput().toStdString() << std::endl;
-            std::cout << "Alternative method stderr: " << process.readAllStandardError().toStdString() << std::endl;
+            // Read stage, overlapping with the workers decoding earlier inputs
+            QByteArray input = inputs.take();
+            bool read;
+            {
+                RecordScope scope(record);
+                PhaseTimer run(Phase::RUN);
+                read = readWholeFile(job.inputFile, input);
+            }
+            if (!read) {
+                std::cerr << "Cannot read " << job.inputFile << std::endl;
+                record.failure = FailureReason::CONVERTER_ERROR;
+                finishRecord(record, job.inputFile, job.outputFile, false);
+                inputs.give(std::move(input));
+                finish(i, false, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+                continue;
+            }
+            double readSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
             
-            // Check again for the output file
-            if (QFile::exists(expectedOutput)) {
-                if (expectedOutput != QString::fromStdString(outputFile)) {
-                    if (QFile::exists(QString::fromStdString(outputFile))) {
-                        QFile::remove(QString::fromStdString(outputFile));
+            pool.submit([this, &job, &finish, &inputs, i, outputFormat, cacheKey, record, readSeconds,
+                         input = std::move(input)]() mutable {
+                // Decode, transform, encode and write stages; the buffers stay
+                // with this worker thread for the rest of the batch
+                thread_local ImageBuffers buffers;
+                auto start = std::chrono::steady_clock::now();
+                bool success = false;
+                {
+                    RecordScope scope(record);
+                    std::unique_ptr<ResourceScheduler::Lease> lease =
+                        acquireLease(costClassFor(Backend::NATIVE, outputFormat));
+                    
+                    std::string error;
+                    if (isCancelled()) {
+                        noteFailure(FailureReason::CANCELLED);
+                    } else {
+                        PhaseTimer run(Phase::RUN);
+                        success = convertImageData(input, outputFormat, buffers, &error) &&
+                                  writeImageFile(job.outputFile, buffers.encoded, &error);
+                        if (!success) {
+                            std::cerr << "Image conversion failed: " << job.inputFile << ": " << error << std::endl;
+                            noteFailure(FailureReason::CONVERTER_ERROR);
+                        }
+                    }
+                    lease.reset();
+                    
+                    if (success) {
+                        storeCached(cacheKey, job.outputFile);
                     }
-                    bool renameSuccess = QFile::rename(expectedOutput, QString::fromStdString(outputFile));
-                    std::cout << "File rename result (alternative method): " << (renameSuccess ? "success" : "failed") << std::endl;
-                    return renameSuccess;
                 }
-                return true;
+                inputs.give(std::move(input));
+                finishRecord(record, job.inputFile, job.outputFile, success);
+                finish(i, success,
+                       readSeconds + std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+            });
+        }
+        
+        for (auto& queue : magickQueues) {
+            if (!queue.second.empty() && !isCancelled()) {
+                submitMagick(queue.first, queue.second);
+            }
+        }
+        
+        pool.wait();
+    }
+    
+    return std::vector<bool>(done.begin(), done.end());
+}
+
+void FileConverter::runMagickBatch(const ToolInfo& magick, const std::vector<ConversionJob>& jobs,
+                                   const std::vector<std::size_t>& run, FileFormat outputFormat,
+                                   std::vector<bool>& produced, std::vector<ConversionRecord>& records) {
+    // mogrify writes <base name>.<format> into -path; each is moved to its requested name
+    QTemporaryDir outputDir(QDir(QDir::tempPath()).filePath("fileconverter-images-XXXXXX"));
+    if (!outputDir.isValid()) {
+        std::cerr << "Cannot create temporary directory for image batch" << std::endl;
+        return;
+    }
+    
+    QString extension = QString::fromStdString(getExtension(outputFormat));
+    
+    // Phases of the whole run, shared out evenly between its images below
+    ConversionRecord shared;
+    QProcess process;
+    {
+        RecordScope scope(shared);
+        std::unique_ptr<ResourceScheduler::Lease> lease = acquireLease(costClassFor(Backend::IMAGEMAGICK, outputFormat));
+        
+        QStringList args;
+        args << "mogrify";
+        if (lease) {
+            args << "-limit" << "thread" << QString::number(static_cast<int>(lease->threads()));
+        }
+        args << "-path" << outputDir.path() << "-format" << extension.mid(1);
+        for (std::size_t index : run) {
+            args << QString::fromStdString(jobs[index].inputFile);
+        }
+        runProcess(process, QString::fromStdString(magick.path), args);
+    }
+    if (isCancelled()) {
+        return;
+    }
+    
+    // mogrify carries on past files it cannot convert, naming each on stderr
+    QStringList errors = QString::fromLocal8Bit(process.readAllStandardError()).split('\n');
+    
+    for (std::size_t k = 0; k < run.size(); ++k) {
+        for (std::size_t phase = 0; phase < kPhaseCount; ++phase) {
+            if (shared.entered[phase]) {
+                records[k].addTime(static_cast<Phase>(phase), shared.seconds[phase] / static_cast<double>(run.size()));
             }
         }
         
-        std::cerr << "Output file not found after conversion!" << std::endl;
+        QFileInfo input(QString::fromStdString(jobs[run[k]].inputFile));
+        QString producedFile = QDir(outputDir.path()).filePath(input.completeBaseName() + extension);
+        if (QFile::exists(producedFile)) {
+            RecordScope scope(records[k]);
+            PhaseTimer rename(Phase::RENAME);
+            QString outputFile = QString::fromStdString(jobs[run[k]].outputFile);
+            QFile::remove(outputFile);
+            produced[k] = QFile::rename(producedFile, outputFile);
+            continue;
+        }
+        for (const QString& line : errors) {
+            if (line.contains(input.fileName())) {
+                std::cerr << "ImageMagick: " << line.toStdString() << std::endl;
+                break;
+            }
+        }
+    }
+}
+
+bool FileConverter::probeStreamCopy(const std::string& inputFile, FileFormat inputFormat, FileFormat outputFormat,
+                                    std::string* reason) const {
+    // Most pairs (e.g. WAV to MP3) can never copy; those start no ffprobe
+    if (!mayStreamCopy(inputFormat, outputFormat)) {
+        return false;
+    }
+    ToolInfo ffprobe = getToolInfo("ffprobe");
+    if (!ffprobe.available) {
+        if (reason) {
+            *reason = "ffprobe is not installed";
+        }
         return false;
     }
     
-    // Use registered converters for any other conversions
-    auto it = converters_.find({inputFormat, outputFormat});
-    if (it != converters_.end()) {
-        return it->second->convert(inputFile, outputFile);
+    QStringList args;
+    for (const std::string& argument : probeArguments(inputFile)) {
+        args << QString::fromStdString(argument);
     }
+    QProcess process;
+    process.start(QString::fromStdString(ffprobe.path), args);
     
-    std::cerr << "Conversion not supported!" << std::endl;
-    return false;
+    // Polled like runProcess() so cancel() does not wait for a slow probe
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(kProbeTimeoutMs);
+    bool finished = false;
+    while (!(finished = process.waitForFinished(kCancelPollIntervalMs))) {
+        if (process.state() == QProcess::NotRunning || cancelled_ || std::chrono::steady_clock::now() >= deadline) {
+            break;
+        }
+    }
+    if (!finished || process.exitStatus() != QProcess::NormalExit || process.exitCode() != 0) {
+        process.kill();
+        process.waitForFinished();
+        if (reason) {
+            *reason = cancelled_ ? "cancelled" : "ffprobe cannot read the input";
+        }
+        return false;
+    }
+    
+    return canStreamCopy(parseProbeStreams(process.readAllStandardOutput().toStdString()), outputFormat, reason);
+}
+
+bool FileConverter::convertWithFfmpeg(const std::string& inputFile, const std::string& outputFile,
+                                      std::size_t threads, bool streamCopy) {
+    ToolInfo ffmpeg = getToolInfo("ffmpeg");
+    if (!ffmpeg.available) {
+        std::cerr << "FFmpeg is not installed!" << std::endl;
+        noteFailure(FailureReason::TOOL_MISSING);
+        return false;
+    }
+    
+    QProcess process;
+    QStringList args;
+    args << "-hide_banner"
+         << "-nostats"
+         << "-progress" << "pipe:1"; // Machine-readable key=value progress on stdout
+    if (!streamCopy && threads > 0) {
+        args << "-threads" << QString::number(static_cast<int>(threads)); // Decoder threads
+    }
+    args << "-i" << QString::fromStdString(inputFile);
+    if (streamCopy) {
+        for (const std::string& option : streamCopyOptions(detectFormat(outputFile))) {
+            args << QString::fromStdString(option);
+        }
+    } else if (threads > 0) {
+        args << "-threads" << QString::number(static_cast<int>(threads)); // Encoder threads
+    }
+    args << "-y" // Overwrite output file if it exists
+         << QString::fromStdString(outputFile);
+    
+    // The input duration comes from the log on stderr, progress blocks from stdout
+    FfmpegProgressParser parser;
+    auto onPoll = [this, &process, &parser]() {
+        QByteArray log = process.readAllStandardError();
+        parser.feedLog(log.constData(), static_cast<std::size_t>(log.size()));
+        
+        QByteArray progress = process.readAllStandardOutput();
+        if (parser.feedProgress(progress.constData(), static_cast<std::size_t>(progress.size())) && progressCallback_) {
+            progressCallback_(parser.current());
+        }
+    };
+    
+    return runProcess(process, QString::fromStdString(ffmpeg.path), args, onPoll) && process.exitCode() == 0;
 }
 
 std::vector<FileFormat> FileConverter::getSupportedFormats() const {
     std::vector<FileFormat> formats;
-    formats.push_back(FileFormat::TXT);
-    formats.push_back(FileFormat::CSV);
-    formats.push_back(FileFormat::JSON);
-    formats.push_back(FileFormat::XML);
+    for (std::size_t index = 0; index < kFormatCount; ++index) {
+        FileFormat format = static_cast<FileFormat>(index);
+        if (!getSupportedOutputFormats(format).empty()) {
+            formats.push_back(format);
+        }
+    }
+    return formats;
+}
+
+std::vector<FileFormat> FileConverter::getSupportedOutputFormats(FileFormat inputFormat) const {
+    std::vector<FileFormat> formats;
+    for (std::size_t index = 0; index < kFormatCount; ++index) {
+        FileFormat format = static_cast<FileFormat>(index);
+        if (format == inputFormat) {
+            continue;
+        }
+        if (routeFor(inputFormat, format) != Backend::NONE ||
+            converters_.count({inputFormat, format}) > 0) {
+            formats.push_back(format);
+        }
+    }
     return formats;
 }
 
 FileFormat FileConverter::detectFormat(const std::string& filename) {
-    // Extract extension manually instead of using filesystem
-    std::string extension;
-    size_t pos = filename.find_last_of('.');
-    if (pos != std::string::npos) {
-        extension = filename.substr(pos);
-    }
-    
-    // Convert to lowercase
-    std::transform(extension.begin(), extension.end(), extension.begin(),
-                   [](unsigned char c) { return std::tolower(c); });
-    
-    // Text formats
-    if (extension == ".txt") return FileFormat::TXT;
-    if (extension == ".csv") return FileFormat::CSV;
-    if (extension == ".json") return FileFormat::JSON;
-    if (extension == ".xml") return FileFormat::XML;
-    if (extension == ".html") return FileFormat::HTML;
-    if (extension == ".md") return FileFormat::MD;
-    
-    // Image formats
-    if (extension == ".jpg" || extension == ".jpeg") return FileFormat::JPG;
-    if (extension == ".png") return FileFormat::PNG;
-    if (extension == ".gif") return FileFormat::GIF;
-    if (extension == ".bmp") return FileFormat::BMP;
-    if (extension == ".tiff" || extension == ".tif") return FileFormat::TIFF;
-    if (extension == ".webp") return FileFormat::WEBP;
-    if (extension == ".svg") return FileFormat::SVG;
-    if (extension == ".ico") return FileFormat::ICO;
-    
-    // Video formats
-    if (extension == ".mp4") return FileFormat::MP4;
-    if (extension == ".avi") return FileFormat::AVI;
-    if (extension == ".mov") return FileFormat::MOV;
-    if (extension == ".mkv") return FileFormat::MKV;
-    if (extension == ".wmv") return FileFormat::WMV;
-    if (extension == ".flv") return FileFormat::FLV;
-    if (extension == ".webm") return FileFormat::WEBM;
-    if (extension == ".m4v") return FileFormat::M4V;
-    
-    // Audio formats
-    if (extension == ".mp3") return FileFormat::MP3;
-    if (extension == ".wav") return FileFormat::WAV;
-    if (extension == ".aac") return FileFormat::AAC;
-    if (extension == ".flac") return FileFormat::FLAC;
-    if (extension == ".ogg") return FileFormat::OGG;
-    if (extension == ".wma") return FileFormat::WMA;
-    
-    // Document formats
-    if (extension == ".pdf") return FileFormat::PDF;
-    if (extension == ".docx") return FileFormat::DOCX;
-    if (extension == ".odt") return FileFormat::ODT;
-    if (extension == ".rtf") return FileFormat::RTF;
-    
-    return FileFormat::UNKNOWN;
+    return formatFromExtension(filename);
+}
+
+FileFormat FileConverter::detectInputFormat(const std::string& filePath) {
+    return resolveFormat(formatFromExtension(filePath), sniffFile(filePath));
 }
 
 std::string FileConverter::getExtension(FileFormat format) {
@@ -470,113 +1429,4 @@ std::string FileConverter::getExtension(FileFormat format) {
     }
 }
 
-bool FileConverter::convertJsonToTxt(const std::string& inputPath, const std::string& outputPath) {
-    try {
-        // Use QProcess to call the appropriate tool for conversion
-        QProcess process;
-        
-        // Check if Pandoc is available
-        process.start("pandoc", QStringList() << "--version");
-        process.waitForFinished();
-        bool pandocAvailable = (process.exitCode() == 0);
-        
-        if (pandocAvailable) {
-            // Use Pandoc for conversion
-            QStringList args;
-            args << QString::fromStdString(inputPath) 
-                 << "-o" << QString::fromStdString(outputPath)
-                 << "--from=json" << "--to=plain";
-            
-            process.start("pandoc", args);
-            process.waitForFinished();
-            
-            return (process.exitCode() == 0);
-        } else {
-            // Fallback to manual conversion using Qt's JSON parser
-            QFile inputFile(QString::fromStdString(inputPath));
-            if (!inputFile.open(QIODevice::ReadOnly)) {
-                return false;
-            }
-            
-            QByteArray jsonData = inputFile.readAll();
-            inputFile.close();
-            
-            QJsonDocument jsonDoc = QJsonDocument::fromJson(jsonData);
-            if (jsonDoc.isNull()) {
-                return false;
-            }
-            
-            QFile outputFile(QString::fromStdString(outputPath));
-            if (!outputFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
-                return false;
-            }
-            
-            QTextStream out(&outputFile);
-            
-            // Convert JSON to plain text
-            if (jsonDoc.isObject()) {
-                convertJsonObjectToText(jsonDoc.object(), out, 0);
-            } else if (jsonDoc.isArray()) {
-                convertJsonArrayToText(jsonDoc.array(), out, 0);
-            }
-            
-            outputFile.close();
-            return true;
-        }
-    } catch (const std::exception& e) {
-        // Log the error
-        qDebug() << "Error converting JSON to TXT: " << e.what();
-        return false;
-    }
-}
-
-void FileConverter::convertJsonObjectToText(const QJsonObject& obj, QTextStream& out, int indent) {
-    QString indentStr(indent, ' ');
-    
-    for (auto it = obj.begin(); it != obj.end(); ++it) {
-        out << indentStr << it.key() << ": ";
-        
-        if (it.value().isObject()) {
-            out << "\n";
-            convertJsonObjectToText(it.value().toObject(), out, indent + 2);
-        } else if (it.value().isArray()) {
-            out << "\n";
-            convertJsonArrayToText(it.value().toArray(), out, indent + 2);
-        } else {
-            out << valueToString(it.value()) << "\n";
-        }
-    }
-}
-
-void FileConverter::convertJsonArrayToText(const QJsonArray& arr, QTextStream& out, int indent) {
-    QString indentStr(indent, ' ');
-    
-    for (int i = 0; i < arr.size(); ++i) {
-        out << indentStr << "- ";
-        
-        if (arr[i].isObject()) {
-            out << "\n";
-            convertJsonObjectToText(arr[i].toObject(), out, indent + 2);
-        } else if (arr[i].isArray()) {
-            out << "\n";
-            convertJsonArrayToText(arr[i].toArray(), out, indent + 2);
-        } else {
-            out << valueToString(arr[i]) << "\n";
-        }
-    }
-}
-
-QString FileConverter::valueToString(const QJsonValue& value) {
-    if (value.isString()) {
-        return value.toString();
-    } else if (value.isBool()) {
-        return value.toBool() ? "true" : "false";
-    } else if (value.isDouble()) {
-        return QString::number(value.toDouble());
-    } else if (value.isNull()) {
-        return "null";
-    }
-    return "";
-}
-
 } // namespace converter
\ No newline at end of file
@@ -0,0 +1,332 @@
+#include "FolderWatcher.h"
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace converter {
+
+namespace {
+
+#ifdef __linux__
+// Events that matter for completed files and for following the directory tree
+constexpr std::uint32_t kWatchMask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MODIFY | IN_CREATE |
+                                     IN_DELETE | IN_MOVED_FROM | IN_ONLYDIR;
+
+// Room for many events per read() (each is 16 bytes plus the name)
+constexpr std::size_t kEventBufferSize = 64 * 1024;
+#else
+// Upper bound of the polling interval
+constexpr int kMaxPollIntervalMs = 100;
+#endif
+
+// Watched paths are absolute; others are made so to match them
+std::string absolutePath(const std::string& path) {
+    return QFileInfo(QString::fromStdString(path)).absoluteFilePath().toStdString();
+}
+
+} // namespace
+
+FolderWatcher::FolderWatcher(WatchOptions options) : options_(std::move(options)) {}
+
+FolderWatcher::~FolderWatcher() {
+#ifdef __linux__
+    for (int fd : {inotifyFd_, wakeFds_[0], wakeFds_[1]}) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+#endif
+}
+
+void FolderWatcher::markPending(const std::string& path) {
+    pending_[path] = Clock::now() + std::chrono::milliseconds(options_.settleMs);
+}
+
+void FolderWatcher::dispatchDue(const ReadyCallback& onReady) {
+    Clock::time_point now = Clock::now();
+    std::vector<std::string> due;
+    for (auto it = pending_.begin(); it != pending_.end();) {
+        if (it->second <= now) {
+            due.push_back(it->first);
+            it = pending_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    for (const std::string& path : due) {
+        if (stopping_) {
+            return;
+        }
+        if (!QFileInfo(QString::fromStdString(path)).isFile()) {
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> lock(progressMutex_);
+            std::string key = absolutePath(path);
+            if (!inProgress_.insert(key).second) {
+                // Still being converted: report it again once that is finished
+                changedInProgress_.insert(key);
+                continue;
+            }
+        }
+        onReady(path);
+    }
+}
+
+void FolderWatcher::claim(const std::string& path) {
+    std::lock_guard<std::mutex> lock(progressMutex_);
+    inProgress_.insert(absolutePath(path));
+}
+
+void FolderWatcher::finished(const std::string& path) {
+    std::string key = absolutePath(path);
+    {
+        std::lock_guard<std::mutex> lock(progressMutex_);
+        inProgress_.erase(key);
+        if (changedInProgress_.erase(key) == 0) {
+            return;
+        }
+        requeued_.push_back(key);
+    }
+    wake();
+}
+
+void FolderWatcher::takeRequeued() {
+    std::vector<std::string> paths;
+    {
+        std::lock_guard<std::mutex> lock(progressMutex_);
+        paths.swap(requeued_);
+    }
+    // They settled already, so they are due right away
+    for (const std::string& path : paths) {
+        pending_[path] = Clock::now();
+    }
+}
+
+int FolderWatcher::msUntilNextDeadline() const {
+    if (pending_.empty()) {
+        return -1;
+    }
+    Clock::time_point next = pending_.begin()->second;
+    for (const auto& entry : pending_) {
+        next = std::min(next, entry.second);
+    }
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(next - Clock::now()).count();
+    return static_cast<int>(std::max<long long>(0, remaining + 1));
+}
+
+#ifdef __linux__
+
+bool FolderWatcher::start() {
+    startedAtMs_ = QDateTime::currentDateTime().toMSecsSinceEpoch();
+
+    inotifyFd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd_ < 0 || ::pipe2(wakeFds_, O_NONBLOCK | O_CLOEXEC) != 0) {
+        std::cerr << "Cannot initialise inotify" << std::endl;
+        return false;
+    }
+
+    QDir root(QString::fromStdString(options_.directory));
+    if (!root.exists() || !addWatch(root.absolutePath().toStdString())) {
+        std::cerr << "Cannot watch directory: " << options_.directory << std::endl;
+        return false;
+    }
+    if (options_.recursive) {
+        QDirIterator it(root.absolutePath(), QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            addWatch(it.next().toStdString());
+        }
+    }
+    return true;
+}
+
+bool FolderWatcher::addWatch(const std::string& directory) {
+    int wd = ::inotify_add_watch(inotifyFd_, directory.c_str(), kWatchMask);
+    if (wd < 0) {
+        std::cerr << "inotify_add_watch failed for " << directory << std::endl;
+        return false;
+    }
+    watches_[wd] = directory;
+    return true;
+}
+
+void FolderWatcher::scanDirectory(const std::string& directory, long long modifiedSinceMs) {
+    QDirIterator it(QString::fromStdString(directory), QDir::Files,
+                    options_.recursive ? QDirIterator::Subdirectories : QDirIterator::NoIteratorFlags);
+    while (it.hasNext()) {
+        QFileInfo file(it.next());
+        if (file.lastModified().toMSecsSinceEpoch() >= modifiedSinceMs) {
+            markPending(file.absoluteFilePath().toStdString());
+        }
+    }
+}
+
+void FolderWatcher::readEvents() {
+    alignas(inotify_event) char buffer[kEventBufferSize];
+
+    for (;;) {
+        ssize_t length = ::read(inotifyFd_, buffer, sizeof(buffer));
+        if (length <= 0) {
+            return;  // EAGAIN: queue drained
+        }
+
+        for (char* p = buffer; p < buffer + length;) {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(p);
+            p += sizeof(inotify_event) + event->len;
+
+            // Events were dropped: look for anything written since watching began
+            if (event->mask & IN_Q_OVERFLOW) {
+                std::cerr << "inotify queue overflowed, rescanning " << options_.directory << std::endl;
+                scanDirectory(options_.directory, startedAtMs_);
+                continue;
+            }
+            if (event->mask & IN_IGNORED) {
+                watches_.erase(event->wd);
+                continue;
+            }
+
+            auto watch = watches_.find(event->wd);
+            if (watch == watches_.end() || event->len == 0) {
+                continue;
+            }
+            std::string path = watch->second + "/" + event->name;
+
+            if (event->mask & IN_ISDIR) {
+                // A new subdirectory may already hold files by the time it is watched
+                if (options_.recursive && (event->mask & (IN_CREATE | IN_MOVED_TO)) && addWatch(path)) {
+                    QDirIterator it(QString::fromStdString(path), QDir::Dirs | QDir::NoDotAndDotDot,
+                                    QDirIterator::Subdirectories);
+                    while (it.hasNext()) {
+                        addWatch(it.next().toStdString());
+                    }
+                    scanDirectory(path, 0);
+                }
+                continue;
+            }
+
+            if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+                markPending(path);
+            } else if (event->mask & IN_MODIFY) {
+                // Written again after closing: restart the quiet period
+                if (pending_.count(path) > 0) {
+                    markPending(path);
+                }
+            } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                pending_.erase(path);
+            }
+        }
+    }
+}
+
+void FolderWatcher::run(const ReadyCallback& onReady) {
+    while (!stopping_) {
+        takeRequeued();
+        pollfd fds[2] = {{inotifyFd_, POLLIN, 0}, {wakeFds_[0], POLLIN, 0}};
+        int ready = ::poll(fds, 2, msUntilNextDeadline());
+        if (ready < 0 && errno != EINTR) {
+            std::cerr << "poll failed while watching " << options_.directory << std::endl;
+            return;
+        }
+        if (stopping_) {
+            return;
+        }
+        if (fds[1].revents & POLLIN) {
+            // Woken by finished(); drain the pipe so the next poll() waits again
+            char drain[64];
+            while (::read(wakeFds_[0], drain, sizeof(drain)) > 0) {
+            }
+        }
+        if (fds[0].revents & POLLIN) {
+            readEvents();
+        }
+        dispatchDue(onReady);
+    }
+}
+
+void FolderWatcher::stop() {
+    stopping_ = true;
+    wake();
+}
+
+void FolderWatcher::wake() {
+    if (wakeFds_[1] >= 0) {
+        // write() is async-signal-safe; a full pipe already holds a wake-up
+        ssize_t ignored = ::write(wakeFds_[1], "x", 1);
+        (void)ignored;
+    }
+}
+
+#else
+
+bool FolderWatcher::start() {
+    startedAtMs_ = QDateTime::currentDateTime().toMSecsSinceEpoch();
+    if (!QDir(QString::fromStdString(options_.directory)).exists()) {
+        std::cerr << "Cannot watch directory: " << options_.directory << std::endl;
+        return false;
+    }
+
+    // Files present now are the baseline, not new arrivals
+    pollDirectory();
+    pending_.clear();
+    return true;
+}
+
+void FolderWatcher::pollDirectory() {
+    std::map<std::string, std::pair<long long, long long>> current;
+    QDirIterator it(QString::fromStdString(options_.directory), QDir::Files,
+                    options_.recursive ? QDirIterator::Subdirectories : QDirIterator::NoIteratorFlags);
+    while (it.hasNext()) {
+        QFileInfo file(it.next());
+        std::string path = file.absoluteFilePath().toStdString();
+        std::pair<long long, long long> state(file.size(), file.lastModified().toMSecsSinceEpoch());
+
+        // New or changed since the last poll: (re)start its quiet period
+        auto previous = seen_.find(path);
+        if (previous == seen_.end() || previous->second != state) {
+            markPending(path);
+        }
+        current[path] = state;
+    }
+
+    for (auto pending = pending_.begin(); pending != pending_.end();) {
+        pending = current.count(pending->first) > 0 ? std::next(pending) : pending_.erase(pending);
+    }
+    seen_ = std::move(current);
+}
+
+void FolderWatcher::run(const ReadyCallback& onReady) {
+    int interval = std::max(1, std::min(options_.settleMs / 2, kMaxPollIntervalMs));
+    while (!stopping_) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(interval));
+        takeRequeued();
+        pollDirectory();
+        dispatchDue(onReady);
+    }
+}
+
+void FolderWatcher::stop() {
+    stopping_ = true;
+}
+
+void FolderWatcher::wake() {
+    // run() polls often enough to pick up requeued files
+}
+
+#endif
+
+} // namespace converter
@@ -0,0 +1,279 @@
+#include "FormatSniffer.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+#include <vector>
+
+namespace converter {
+
+namespace {
+
+constexpr FormatMask kTextMask =
+    formatBit(FileFormat::TXT) | formatBit(FileFormat::CSV) | formatBit(FileFormat::JSON) |
+    formatBit(FileFormat::XML) | formatBit(FileFormat::HTML) | formatBit(FileFormat::MD);
+
+constexpr FormatMask kIsoMediaMask =
+    formatBit(FileFormat::MP4) | formatBit(FileFormat::MOV) | formatBit(FileFormat::M4V);
+
+constexpr FormatMask kMatroskaMask = formatBit(FileFormat::MKV) | formatBit(FileFormat::WEBM);
+
+constexpr FormatMask kAsfMask = formatBit(FileFormat::WMV) | formatBit(FileFormat::WMA);
+
+SniffResult match(FileFormat format, FormatMask compatible) {
+    SniffResult result;
+    result.format = format;
+    result.compatible = compatible | formatBit(format);
+    return result;
+}
+
+SniffResult exact(FileFormat format) {
+    return match(format, 0);
+}
+
+bool bytesAt(const unsigned char* data, std::size_t size, std::size_t offset, const char* bytes, std::size_t length) {
+    return offset + length <= size && std::memcmp(data + offset, bytes, length) == 0;
+}
+
+bool contains(const unsigned char* data, std::size_t size, const char* needle) {
+    const char* begin = reinterpret_cast<const char*>(data);
+    const char* end = begin + size;
+    std::size_t length = std::strlen(needle);
+    return std::search(begin, end, needle, needle + length) != end;
+}
+
+bool containsNoCase(const unsigned char* data, std::size_t size, const char* needle) {
+    const char* begin = reinterpret_cast<const char*>(data);
+    const char* end = begin + size;
+    std::size_t length = std::strlen(needle);
+    return std::search(begin, end, needle, needle + length, [](char a, char b) {
+        return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+    }) != end;
+}
+
+// Refiners look past the shared container header to name the actual format
+
+SniffResult refineRiff(const unsigned char* data, std::size_t size) {
+    if (bytesAt(data, size, 8, "WAVE", 4)) return exact(FileFormat::WAV);
+    if (bytesAt(data, size, 8, "AVI ", 4)) return exact(FileFormat::AVI);
+    if (bytesAt(data, size, 8, "WEBP", 4)) return exact(FileFormat::WEBP);
+    return SniffResult();
+}
+
+SniffResult refineBmp(const unsigned char* data, std::size_t size) {
+    // "BM" alone is common in text; require a known DIB header size after the file header
+    if (size < 18 || data[15] != 0 || data[16] != 0 || data[17] != 0) return SniffResult();
+    switch (data[14]) {
+        case 12: case 40: case 52: case 56: case 64: case 108: case 124:
+            return exact(FileFormat::BMP);
+        default:
+            return SniffResult();
+    }
+}
+
+SniffResult refineZip(const unsigned char* data, std::size_t size) {
+    // ODF stores an uncompressed "mimetype" entry first; OOXML has a word/ part
+    if (bytesAt(data, size, 30, "mimetype", 8) &&
+        contains(data, size, "application/vnd.oasis.opendocument.text")) {
+        return exact(FileFormat::ODT);
+    }
+    if (contains(data, size, "word/")) {
+        return exact(FileFormat::DOCX);
+    }
+    return SniffResult();
+}
+
+SniffResult refineMatroska(const unsigned char* data, std::size_t size) {
+    // The EBML header carries the DocType string
+    if (contains(data, size, "webm")) {
+        return match(FileFormat::WEBM, kMatroskaMask);
+    }
+    return match(FileFormat::MKV, kMatroskaMask);
+}
+
+SniffResult refineMpegAudio(const unsigned char* data, std::size_t size) {
+    if (size < 2) return SniffResult();
+    // ADTS: 12-bit sync, layer bits zero
+    if ((data[1] & 0xF6) == 0xF0) return exact(FileFormat::AAC);
+    // MPEG audio frame: 11-bit sync, layer III
+    if ((data[1] & 0xE0) == 0xE0 && (data[1] & 0x06) == 0x02) return exact(FileFormat::MP3);
+    return SniffResult();
+}
+
+SniffResult refineRtf(const unsigned char*, std::size_t) {
+    return exact(FileFormat::RTF);
+}
+
+struct Signature {
+    const char* magic;
+    std::size_t length;
+    FileFormat format;
+    FormatMask compatible;
+    SniffResult (*refine)(const unsigned char* data, std::size_t size);
+};
+
+// Signatures anchored at offset 0. Entries sharing a first byte are tried in
+// this order, so longer and more specific ones come first.
+const Signature kSignatures[] = {
+    {"\x89PNG\r\n\x1A\n", 8, FileFormat::PNG, 0, nullptr},
+    {"\xFF\xD8\xFF", 3, FileFormat::JPG, 0, nullptr},
+    {"\xFF", 1, FileFormat::UNKNOWN, 0, refineMpegAudio},
+    {"GIF87a", 6, FileFormat::GIF, 0, nullptr},
+    {"GIF89a", 6, FileFormat::GIF, 0, nullptr},
+    {"BM", 2, FileFormat::UNKNOWN, 0, refineBmp},
+    {"II*\0", 4, FileFormat::TIFF, 0, nullptr},
+    {"MM\0*", 4, FileFormat::TIFF, 0, nullptr},
+    {"\0\0\1\0", 4, FileFormat::ICO, 0, nullptr},
+    {"RIFF", 4, FileFormat::UNKNOWN, 0, refineRiff},
+    {"\x1A\x45\xDF\xA3", 4, FileFormat::UNKNOWN, 0, refineMatroska},
+    {"\x30\x26\xB2\x75\x8E\x66\xCF\x11", 8, FileFormat::WMV, kAsfMask, nullptr},
+    {"FLV\x01", 4, FileFormat::FLV, 0, nullptr},
+    {"ID3", 3, FileFormat::MP3, 0, nullptr},
+    {"fLaC", 4, FileFormat::FLAC, 0, nullptr},
+    {"OggS", 4, FileFormat::OGG, 0, nullptr},
+    {"%PDF-", 5, FileFormat::PDF, 0, nullptr},
+    {"PK\x03\x04", 4, FileFormat::UNKNOWN, 0, refineZip},
+    {"{\\rtf", 5, FileFormat::UNKNOWN, 0, refineRtf},
+};
+
+// Signatures bucketed by their first byte, so a lookup only tries the few
+// entries that can possibly match instead of the whole list
+using JumpTable = std::array<std::vector<const Signature*>, 256>;
+
+const JumpTable& jumpTable() {
+    static const JumpTable table = [] {
+        JumpTable buckets;
+        for (const Signature& signature : kSignatures) {
+            buckets[static_cast<unsigned char>(signature.magic[0])].push_back(&signature);
+        }
+        return buckets;
+    }();
+    return table;
+}
+
+SniffResult sniffBinary(const unsigned char* data, std::size_t size) {
+    for (const Signature* signature : jumpTable()[data[0]]) {
+        if (!bytesAt(data, size, 0, signature->magic, signature->length)) {
+            continue;
+        }
+        SniffResult result = signature->refine ? signature->refine(data, size)
+                                               : match(signature->format, signature->compatible);
+        if (result.format != FileFormat::UNKNOWN) {
+            return result;
+        }
+    }
+
+    // ISO base media files start with a box size, the "ftyp" tag follows it
+    if (bytesAt(data, size, 4, "ftyp", 4)) {
+        if (bytesAt(data, size, 8, "qt  ", 4)) return match(FileFormat::MOV, kIsoMediaMask);
+        if (bytesAt(data, size, 8, "M4V", 3)) return match(FileFormat::M4V, kIsoMediaMask);
+        if (bytesAt(data, size, 8, "M4A ", 4)) return exact(FileFormat::AAC);
+        return match(FileFormat::MP4, kIsoMediaMask);
+    }
+
+    return SniffResult();
+}
+
+// Markup and JSON have no magic number, only a recognisable first character.
+// Text formats are interchangeable for this purpose, so a match is compatible
+// with every text extension.
+SniffResult sniffText(const unsigned char* data, std::size_t size) {
+    std::size_t pos = bytesAt(data, size, 0, "\xEF\xBB\xBF", 3) ? 3 : 0;
+    while (pos < size && std::isspace(data[pos])) {
+        ++pos;
+    }
+    if (pos == size) {
+        return SniffResult();
+    }
+
+    if (data[pos] == '{' || data[pos] == '[') {
+        return match(FileFormat::JSON, kTextMask);
+    }
+    if (data[pos] == '<') {
+        if (contains(data + pos, size - pos, "<svg")) {
+            return match(FileFormat::SVG, kTextMask);
+        }
+        if (containsNoCase(data + pos, size - pos, "<!doctype html") ||
+            containsNoCase(data + pos, size - pos, "<html")) {
+            return match(FileFormat::HTML, kTextMask);
+        }
+        if (bytesAt(data, size, pos, "<?xml", 5)) {
+            return match(FileFormat::XML, kTextMask);
+        }
+    }
+    return SniffResult();
+}
+
+} // namespace
+
+FileFormat formatFromExtension(const std::string& filename) {
+    static const std::unordered_map<std::string, FileFormat> kExtensions = {
+        // Text formats
+        {"txt", FileFormat::TXT}, {"csv", FileFormat::CSV}, {"json", FileFormat::JSON},
+        {"xml", FileFormat::XML}, {"html", FileFormat::HTML}, {"md", FileFormat::MD},
+        // Image formats
+        {"jpg", FileFormat::JPG}, {"jpeg", FileFormat::JPG}, {"png", FileFormat::PNG},
+        {"gif", FileFormat::GIF}, {"bmp", FileFormat::BMP}, {"tiff", FileFormat::TIFF},
+        {"tif", FileFormat::TIFF}, {"webp", FileFormat::WEBP}, {"svg", FileFormat::SVG},
+        {"ico", FileFormat::ICO},
+        // Video formats
+        {"mp4", FileFormat::MP4}, {"avi", FileFormat::AVI}, {"mov", FileFormat::MOV},
+        {"mkv", FileFormat::MKV}, {"wmv", FileFormat::WMV}, {"flv", FileFormat::FLV},
+        {"webm", FileFormat::WEBM}, {"m4v", FileFormat::M4V},
+        // Audio formats
+        {"mp3", FileFormat::MP3}, {"wav", FileFormat::WAV}, {"aac", FileFormat::AAC},
+        {"flac", FileFormat::FLAC}, {"ogg", FileFormat::OGG}, {"wma", FileFormat::WMA},
+        // Document formats
+        {"pdf", FileFormat::PDF}, {"docx", FileFormat::DOCX}, {"odt", FileFormat::ODT},
+        {"rtf", FileFormat::RTF},
+    };
+
+    std::size_t pos = filename.find_last_of('.');
+    if (pos == std::string::npos) {
+        return FileFormat::UNKNOWN;
+    }
+
+    std::string extension = filename.substr(pos + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+
+    auto it = kExtensions.find(extension);
+    return it != kExtensions.end() ? it->second : FileFormat::UNKNOWN;
+}
+
+SniffResult sniffFormat(const unsigned char* data, std::size_t size) {
+    if (size == 0) {
+        return SniffResult();
+    }
+
+    SniffResult result = sniffBinary(data, size);
+    if (result.format == FileFormat::UNKNOWN) {
+        result = sniffText(data, size);
+    }
+    return result;
+}
+
+SniffResult sniffFile(const std::string& filePath) {
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file) {
+        return SniffResult();
+    }
+
+    unsigned char buffer[kSniffSize];
+    file.read(reinterpret_cast<char*>(buffer), sizeof(buffer));
+    return sniffFormat(buffer, static_cast<std::size_t>(file.gcount()));
+}
+
+FileFormat resolveFormat(FileFormat fromExtension, const SniffResult& sniffed) {
+    if (sniffed.format == FileFormat::UNKNOWN) {
+        return fromExtension;
+    }
+    if (fromExtension != FileFormat::UNKNOWN && (sniffed.compatible & formatBit(fromExtension))) {
+        return fromExtension;
+    }
+    return sniffed.format;
+}
+
+} // namespace converter
@@ -0,0 +1,151 @@
+#include "ImageCodec.h"
+#include <QBuffer>
+#include <QByteArray>
+#include <QColor>
+#include <QFile>
+#include <QImage>
+#include <QImageReader>
+#include <QImageWriter>
+#include <QList>
+#include <QPainter>
+#include <QString>
+
+namespace converter {
+
+namespace {
+
+// Largest icon the ICO format (and Qt's writer) can hold
+constexpr int kMaxIconSize = 256;
+
+// ImageMagick's default JPEG quality, so switching engines keeps file sizes
+constexpr int kJpegQuality = 92;
+
+// Qt's name for a raster format; empty for formats not handled in-process
+QByteArray qtFormatName(FileFormat format) {
+    switch (format) {
+        case FileFormat::JPG: return "jpeg";
+        case FileFormat::PNG: return "png";
+        case FileFormat::GIF: return "gif";
+        case FileFormat::BMP: return "bmp";
+        case FileFormat::TIFF: return "tiff";
+        case FileFormat::WEBP: return "webp";
+        case FileFormat::ICO: return "ico";
+        default: return QByteArray();
+    }
+}
+
+bool hasAlphaChannel(FileFormat format) {
+    return format != FileFormat::JPG && format != FileFormat::BMP;
+}
+
+bool listed(const QList<QByteArray>& formats, const QByteArray& name) {
+    return !name.isEmpty() && formats.contains(name);
+}
+
+void setError(std::string* error, const std::string& message) {
+    if (error) {
+        *error = message;
+    }
+}
+
+} // namespace
+
+bool qtCanConvertImage(FileFormat input, FileFormat output) {
+    // Plugins are looked up once; the lists do not change while running
+    static const QList<QByteArray> readable = QImageReader::supportedImageFormats();
+    static const QList<QByteArray> writable = QImageWriter::supportedImageFormats();
+    return listed(readable, qtFormatName(input)) && listed(writable, qtFormatName(output));
+}
+
+bool qtAcceptsImage(const std::string& inputFile, FileFormat output) {
+    QImageReader reader(QString::fromStdString(inputFile));
+    reader.setDecideFormatFromContent(true);
+    if (!reader.canRead()) {
+        return false;
+    }
+    // ImageMagick keeps every frame of an animation (or writes one file per frame)
+    if (reader.imageCount() > 1) {
+        return false;
+    }
+    if (output == FileFormat::ICO) {
+        QSize size = reader.size();
+        return size.isValid() && size.width() <= kMaxIconSize && size.height() <= kMaxIconSize;
+    }
+    return true;
+}
+
+bool convertImageData(const QByteArray& input, FileFormat output, ImageBuffers& buffers, std::string* error) {
+    QByteArray formatName = qtFormatName(output);
+    if (formatName.isEmpty()) {
+        setError(error, "format is not handled in-process");
+        return false;
+    }
+
+    QBuffer source;
+    source.setData(input);
+    source.open(QIODevice::ReadOnly);
+    QImageReader reader(&source);
+    reader.setDecideFormatFromContent(true);
+    reader.setAutoTransform(true);
+    if (!reader.read(&buffers.decoded)) {
+        setError(error, "cannot decode image: " + reader.errorString().toStdString());
+        return false;
+    }
+
+    // Transparent pixels keep arbitrary colours underneath; show them as white
+    const QImage* image = &buffers.decoded;
+    if (image->hasAlphaChannel() && !hasAlphaChannel(output)) {
+        if (buffers.flattened.size() != image->size()) {
+            buffers.flattened = QImage(image->size(), QImage::Format_RGB32);
+        }
+        buffers.flattened.fill(Qt::white);
+        QPainter painter(&buffers.flattened);
+        painter.drawImage(0, 0, *image);
+        painter.end();
+        image = &buffers.flattened;
+    }
+
+    // resize(0) keeps the allocation for the next image
+    buffers.encoded.resize(0);
+    QBuffer target(&buffers.encoded);
+    target.open(QIODevice::WriteOnly);
+    QImageWriter writer(&target, formatName);
+    if (output == FileFormat::JPG) {
+        writer.setQuality(kJpegQuality);
+    }
+    if (!writer.write(*image)) {
+        setError(error, "cannot encode image: " + writer.errorString().toStdString());
+        return false;
+    }
+    return true;
+}
+
+bool writeImageFile(const std::string& outputFile, const QByteArray& data, std::string* error) {
+    QFile file(QString::fromStdString(outputFile));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(data) != data.size()) {
+        setError(error, "cannot write " + outputFile + ": " + file.errorString().toStdString());
+        file.close();
+        QFile::remove(QString::fromStdString(outputFile));
+        return false;
+    }
+    return true;
+}
+
+bool convertImageFile(const std::string& inputFile, const std::string& outputFile, FileFormat output,
+                      std::string* error) {
+    QFile file(QString::fromStdString(inputFile));
+    if (!file.open(QIODevice::ReadOnly)) {
+        setError(error, "cannot open " + inputFile);
+        return false;
+    }
+    QByteArray input = file.readAll();
+    file.close();
+
+    ImageBuffers buffers;
+    if (!convertImageData(input, output, buffers, error)) {
+        return false;
+    }
+    return writeImageFile(outputFile, buffers.encoded, error);
+}
+
+} // namespace converter
@@ -0,0 +1,334 @@
+#include "JsonReader.h"
+#include "Utf8.h"
+#include <cstdio>
+#include <istream>
+
+namespace converter {
+
+namespace {
+
+// Input is read in blocks of this size (64 KiB)
+constexpr std::size_t kJsonReadSize = 1 << 16;
+
+} // namespace
+
+JsonReader::JsonReader(std::istream& input) : input_(input), buffer_(kJsonReadSize) {}
+
+int JsonReader::peek() {
+    if (pos_ == end_) {
+        consumed_ += end_;
+        input_.read(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+        end_ = static_cast<std::size_t>(input_.gcount());
+        pos_ = 0;
+        if (end_ == 0) {
+            return EOF;
+        }
+    }
+    return static_cast<unsigned char>(buffer_[pos_]);
+}
+
+int JsonReader::get() {
+    int c = peek();
+    if (c != EOF) {
+        ++pos_;
+    }
+    return c;
+}
+
+void JsonReader::skipWhitespace() {
+    for (int c = peek(); c == ' ' || c == '\t' || c == '\n' || c == '\r'; c = peek()) {
+        ++pos_;
+    }
+}
+
+JsonReader::Token JsonReader::fail(const std::string& message) {
+    if (error_.empty()) {
+        error_ = message + " at byte " + std::to_string(consumed_ + pos_);
+    }
+    state_ = State::DONE;
+    return Token::ERROR;
+}
+
+bool JsonReader::parseString() {
+    text_.clear();
+    if (get() != '"') {
+        fail("expected string");
+        return false;
+    }
+
+    auto readHex = [this](unsigned long& unit) {
+        unit = 0;
+        for (int i = 0; i < 4; ++i) {
+            int c = get();
+            unit <<= 4;
+            if (c >= '0' && c <= '9') unit |= static_cast<unsigned long>(c - '0');
+            else if (c >= 'a' && c <= 'f') unit |= static_cast<unsigned long>(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F') unit |= static_cast<unsigned long>(c - 'A' + 10);
+            else return false;
+        }
+        return true;
+    };
+
+    for (;;) {
+        int c = get();
+        if (c == EOF) {
+            fail("unterminated string");
+            return false;
+        }
+        if (c == '"') {
+            return true;
+        }
+        if (c < 0x20) {
+            fail("control character in string");
+            return false;
+        }
+        if (c != '\\') {
+            text_ += static_cast<char>(c);
+            continue;
+        }
+
+        switch (get()) {
+            case '"': text_ += '"'; break;
+            case '\\': text_ += '\\'; break;
+            case '/': text_ += '/'; break;
+            case 'b': text_ += '\b'; break;
+            case 'f': text_ += '\f'; break;
+            case 'n': text_ += '\n'; break;
+            case 'r': text_ += '\r'; break;
+            case 't': text_ += '\t'; break;
+            case 'u': {
+                unsigned long unit;
+                if (!readHex(unit)) {
+                    fail("invalid \\u escape");
+                    return false;
+                }
+                // A high surrogate combines with the following low surrogate
+                if (unit >= 0xD800 && unit <= 0xDBFF && peek() == '\\') {
+                    get();
+                    unsigned long low;
+                    if (get() != 'u' || !readHex(low) || low < 0xDC00 || low > 0xDFFF) {
+                        fail("invalid surrogate pair");
+                        return false;
+                    }
+                    unit = 0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00);
+                }
+                appendUtf8(text_, unit);
+                break;
+            }
+            default:
+                fail("invalid escape");
+                return false;
+        }
+    }
+}
+
+bool JsonReader::parseNumber() {
+    text_.clear();
+    auto digits = [this]() {
+        std::size_t count = 0;
+        for (int c = peek(); c >= '0' && c <= '9'; c = peek(), ++count) {
+            text_ += static_cast<char>(get());
+        }
+        return count;
+    };
+
+    if (peek() == '-') {
+        text_ += static_cast<char>(get());
+    }
+    bool valid = true;
+    if (peek() == '0') {
+        text_ += static_cast<char>(get());
+    } else {
+        valid = digits() > 0;
+    }
+    if (valid && peek() == '.') {
+        text_ += static_cast<char>(get());
+        valid = digits() > 0;
+    }
+    if (valid && (peek() == 'e' || peek() == 'E')) {
+        text_ += static_cast<char>(get());
+        if (peek() == '+' || peek() == '-') {
+            text_ += static_cast<char>(get());
+        }
+        valid = digits() > 0;
+    }
+    if (!valid) {
+        fail("invalid number");
+    }
+    return valid;
+}
+
+bool JsonReader::parseLiteral(const char* literal) {
+    for (const char* p = literal; *p; ++p) {
+        if (get() != *p) {
+            fail("invalid literal");
+            return false;
+        }
+    }
+    return true;
+}
+
+JsonReader::Token JsonReader::scalar() {
+    int c = peek();
+    if (c == '"') {
+        return parseString() ? Token::STRING : Token::ERROR;
+    }
+    if (c == '-' || (c >= '0' && c <= '9')) {
+        return parseNumber() ? Token::NUMBER : Token::ERROR;
+    }
+    if (c == 't') {
+        return parseLiteral("true") ? Token::TRUE_VALUE : Token::ERROR;
+    }
+    if (c == 'f') {
+        return parseLiteral("false") ? Token::FALSE_VALUE : Token::ERROR;
+    }
+    if (c == 'n') {
+        return parseLiteral("null") ? Token::NULL_VALUE : Token::ERROR;
+    }
+    return fail(c == EOF ? "unexpected end of input" : "unexpected character");
+}
+
+JsonReader::Token JsonReader::next() {
+    for (;;) {
+        switch (state_) {
+            case State::VALUE: {
+                skipWhitespace();
+                int c = peek();
+                if (c == '{' || c == '[') {
+                    get();
+                    stack_.push_back(c == '[');
+                    state_ = (c == '[') ? State::ARRAY_START : State::OBJECT_START;
+                    return (c == '[') ? Token::BEGIN_ARRAY : Token::BEGIN_OBJECT;
+                }
+                Token token = scalar();
+                if (token != Token::ERROR) {
+                    state_ = State::AFTER_VALUE;
+                }
+                return token;
+            }
+
+            case State::OBJECT_START:
+            case State::ARRAY_START: {
+                skipWhitespace();
+                bool array = (state_ == State::ARRAY_START);
+                if (peek() == (array ? ']' : '}')) {
+                    get();
+                    stack_.pop_back();
+                    state_ = State::AFTER_VALUE;
+                    return array ? Token::END_ARRAY : Token::END_OBJECT;
+                }
+                state_ = array ? State::VALUE : State::MEMBER;
+                break;
+            }
+
+            case State::MEMBER: {
+                skipWhitespace();
+                if (!parseString()) {
+                    return Token::ERROR;
+                }
+                skipWhitespace();
+                if (get() != ':') {
+                    return fail("expected ':'");
+                }
+                state_ = State::VALUE;
+                return Token::KEY;
+            }
+
+            case State::AFTER_VALUE: {
+                skipWhitespace();
+                if (stack_.empty()) {
+                    if (peek() != EOF) {
+                        return fail("unexpected data after document");
+                    }
+                    state_ = State::DONE;
+                    return input_.bad() ? fail("read error") : Token::END;
+                }
+
+                bool array = stack_.back();
+                int c = get();
+                if (c == ',') {
+                    state_ = array ? State::VALUE : State::MEMBER;
+                } else if (c == (array ? ']' : '}')) {
+                    stack_.pop_back();
+                    return array ? Token::END_ARRAY : Token::END_OBJECT;
+                } else {
+                    return fail(array ? "expected ',' or ']'" : "expected ',' or '}'");
+                }
+                break;
+            }
+
+            case State::DONE:
+                return error_.empty() ? Token::END : Token::ERROR;
+        }
+    }
+}
+
+void appendJsonString(std::string& out, const std::string& value) {
+    out += '"';
+    for (char ch : value) {
+        unsigned char c = static_cast<unsigned char>(ch);
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            default:
+                if (c < 0x20) {
+                    char escape[8];
+                    std::snprintf(escape, sizeof(escape), "\\u%04x", c);
+                    out += escape;
+                } else {
+                    out += ch;
+                }
+        }
+    }
+    out += '"';
+}
+
+bool appendJsonValue(JsonReader& reader, JsonReader::Token token, std::string& out) {
+    using Token = JsonReader::Token;
+
+    // One flag per open container: true until its first element is written
+    std::vector<bool> first;
+    bool afterKey = false;
+
+    for (;;) {
+        bool closing = (token == Token::END_OBJECT || token == Token::END_ARRAY);
+        if (!closing && !afterKey && !first.empty()) {
+            if (!first.back()) {
+                out += ',';
+            }
+            first.back() = false;
+        }
+        afterKey = false;
+
+        switch (token) {
+            case Token::BEGIN_OBJECT: out += '{'; first.push_back(true); break;
+            case Token::BEGIN_ARRAY: out += '['; first.push_back(true); break;
+            case Token::END_OBJECT: out += '}'; first.pop_back(); break;
+            case Token::END_ARRAY: out += ']'; first.pop_back(); break;
+            case Token::KEY:
+                appendJsonString(out, reader.text());
+                out += ':';
+                afterKey = true;
+                break;
+            case Token::STRING: appendJsonString(out, reader.text()); break;
+            case Token::NUMBER: out += reader.text(); break;
+            case Token::TRUE_VALUE: out += "true"; break;
+            case Token::FALSE_VALUE: out += "false"; break;
+            case Token::NULL_VALUE: out += "null"; break;
+            default:
+                return false;
+        }
+
+        if (first.empty()) {
+            return true;
+        }
+        token = reader.next();
+    }
+}
+
+} // namespace converter
@@ -0,0 +1,116 @@
+#include "JsonText.h"
+#include "JsonReader.h"
+#include <charconv>
+#include <cstdio>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+namespace converter {
+
+namespace {
+
+// Output is written in blocks of this size (64 KiB)
+constexpr std::size_t kJsonWriteSize = 1 << 16;
+
+// Locale-independent conversion; six significant digits like printf's %g
+void appendNumber(std::string& out, const std::string& text) {
+    double number = 0.0;
+    std::from_chars(text.data(), text.data() + text.size(), number);
+    char digits[32];
+    auto result = std::to_chars(digits, digits + sizeof(digits), number, std::chars_format::general, 6);
+    out.append(digits, result.ptr);
+}
+
+} // namespace
+
+bool renderJsonText(std::istream& input, std::ostream& output, std::string* error) {
+    using Token = JsonReader::Token;
+
+    JsonReader reader(input);
+    std::string buffer;
+    // Open containers, true for arrays
+    std::vector<bool> stack;
+
+    // Members of the outermost container start at column zero
+    auto indent = [&]() {
+        buffer.append(2 * (stack.size() - 1), ' ');
+    };
+
+    for (;;) {
+        Token token = reader.next();
+        if (token == Token::END || token == Token::ERROR) {
+            output.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            output.flush();
+            if (token == Token::ERROR) {
+                if (error) *error = reader.error();
+                return false;
+            }
+            return output.good();
+        }
+
+        if (token == Token::KEY) {
+            indent();
+            buffer += reader.text();
+            buffer += ": ";
+            continue;
+        }
+        if (token == Token::END_OBJECT || token == Token::END_ARRAY) {
+            stack.pop_back();
+            continue;
+        }
+
+        // Any other token starts a value; inside an array it gets its own dash
+        if (!stack.empty() && stack.back()) {
+            indent();
+            buffer += "- ";
+        }
+
+        switch (token) {
+            case Token::BEGIN_OBJECT:
+            case Token::BEGIN_ARRAY:
+                // A nested container starts on the line after its key or dash
+                if (!stack.empty()) {
+                    buffer += '\n';
+                }
+                stack.push_back(token == Token::BEGIN_ARRAY);
+                break;
+            case Token::STRING: buffer += reader.text(); buffer += '\n'; break;
+            case Token::NUMBER: appendNumber(buffer, reader.text()); buffer += '\n'; break;
+            case Token::TRUE_VALUE: buffer += "true\n"; break;
+            case Token::FALSE_VALUE: buffer += "false\n"; break;
+            default: buffer += "null\n"; break;
+        }
+
+        if (buffer.size() >= kJsonWriteSize) {
+            output.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+    }
+}
+
+bool renderJsonTextFile(const std::string& inputPath, const std::string& outputPath, std::string* error) {
+    std::ifstream input(inputPath, std::ios::binary);
+    if (!input) {
+        if (error) *error = "cannot open " + inputPath;
+        return false;
+    }
+
+    bool ok;
+    {
+        std::ofstream output(outputPath);
+        if (!output) {
+            if (error) *error = "cannot create " + outputPath;
+            return false;
+        }
+        ok = renderJsonText(input, output, error);
+    }
+
+    if (!ok) {
+        std::remove(outputPath.c_str());
+    }
+    return ok;
+}
+
+} // namespace converter
@@ -1,4 +1,5 @@
 #include "MainWindow.h"
+#include "ConversionWorker.h"
 #include "ui_MainWindow.h"
 #include <QFileDialog>
 #include <QMessageBox>
@@ -6,60 +7,45 @@
 #include <QFileInfo>
 #include <QDir>
 #include <QApplication>
+#include <QDragEnterEvent>
+#include <QDropEvent>
+#include <QMimeData>
+#include <QUrl>
+#include <algorithm>
 
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
     ui(new Ui::MainWindow),
     fileConverter(),
-    isDarkMode(false)
+    isDarkMode(false),
+    worker(nullptr),
+    conversionRunning(false),
+    totalConversions(0),
+    completedConversions(0),
+    failedConversions(0)
 {
     ui->setupUi(this);
     
+    // Conversions run on a worker thread so the window never blocks
+    worker = new ConversionWorker(fileConverter);
+    worker->moveToThread(&workerThread);
+    connect(&workerThread, &QThread::finished, worker, &QObject::deleteLater);
+    connect(this, &MainWindow::conversionRequested, worker, &ConversionWorker::convert);
+    connect(worker, &ConversionWorker::conversionStarted, this, &MainWindow::onConversionStarted);
+    connect(worker, &ConversionWorker::progressChanged, this, &MainWindow::onConversionProgress);
+    connect(worker, &ConversionWorker::conversionFinished, this, &MainWindow::onConversionFinished);
+    workerThread.start();
+    
+    // Files dropped on the window are queued for conversion
+    setAcceptDrops(true);
+    
     // Set window properties for a more modern look
     setWindowTitle("Modern File Converter");
     
-    // Manually add all supported formats to the input combo box
-    // Text formats
-    ui->inputFormatCombo->addItem(".txt");
-    ui->inputFormatCombo->addItem(".csv");
-    ui->inputFormatCombo->addItem(".json");
-    ui->inputFormatCombo->addItem(".xml");
-    ui->inputFormatCombo->addItem(".html");
-    ui->inputFormatCombo->addItem(".md");
-    
-    // Image formats
-    ui->inputFormatCombo->addItem(".jpg");
-    ui->inputFormatCombo->addItem(".png");
-    ui->inputFormatCombo->addItem(".gif");
-    ui->inputFormatCombo->addItem(".bmp");
-    ui->inputFormatCombo->addItem(".tiff");
-    ui->inputFormatCombo->addItem(".webp");
-    ui->inputFormatCombo->addItem(".svg");
-    ui->inputFormatCombo->addItem(".ico");
-    
-    // Video formats
-    ui->inputFormatCombo->addItem(".mp4");
-    ui->inputFormatCombo->addItem(".avi");
-    ui->inputFormatCombo->addItem(".mov");
-    ui->inputFormatCombo->addItem(".mkv");
-    ui->inputFormatCombo->addItem(".wmv");
-    ui->inputFormatCombo->addItem(".flv");
-    ui->inputFormatCombo->addItem(".webm");
-    ui->inputFormatCombo->addItem(".m4v");
-    
-    // Audio formats
-    ui->inputFormatCombo->addItem(".mp3");
-    ui->inputFormatCombo->addItem(".wav");
-    ui->inputFormatCombo->addItem(".aac");
-    ui->inputFormatCombo->addItem(".flac");
-    ui->inputFormatCombo->addItem(".ogg");
-    ui->inputFormatCombo->addItem(".wma");
-    
-    // Document formats
-    ui->inputFormatCombo->addItem(".pdf");
-    ui->inputFormatCombo->addItem(".docx");
-    ui->inputFormatCombo->addItem(".odt");
-    ui->inputFormatCombo->addItem(".rtf");
+    // Input formats come from the conversion route table
+    for (auto format : fileConverter.getSupportedFormats()) {
+        ui->inputFormatCombo->addItem(QString::fromStdString(converter::FileConverter::getExtension(format)));
+    }
     
     // Connect signals
     connect(ui->inputFormatCombo, &QComboBox::currentTextChanged, this, &MainWindow::updateOutputFormats);
@@ -77,6 +63,12 @@ MainWindow::MainWindow(QWidget *parent) :
 
 MainWindow::~MainWindow()
 {
+    // Stop any running tool before tearing down the worker thread
+    pendingConversions.clear();
+    fileConverter.cancel();
+    workerThread.quit();
+    workerThread.wait();
+    
     delete ui;
 }
 
@@ -115,96 +107,171 @@ void MainWindow::on_convertButton_clicked()
         return;
     }
     
-    ui->convertButton->setEnabled(false);
-    ui->statusBar->showMessage("Converting...");
+    enqueueConversion(inputFile, outputFile);
+}
+
+void MainWindow::on_cancelButton_clicked()
+{
+    // Drop everything still queued and kill the tool of the running conversion
+    pendingConversions.clear();
+    if (conversionRunning) {
+        fileConverter.cancel();
+        ui->statusBar->showMessage("Cancelling...");
+    }
+}
+
+void MainWindow::dragEnterEvent(QDragEnterEvent *event)
+{
+    if (event->mimeData()->hasUrls()) {
+        event->acceptProposedAction();
+    }
+}
+
+void MainWindow::dropEvent(QDropEvent *event)
+{
+    int skipped = 0;
+    for (const QUrl& url : event->mimeData()->urls()) {
+        QString inputFile = url.toLocalFile();
+        QString outputFile = getOutputFilePathFor(inputFile);
+        if (inputFile.isEmpty() || outputFile.isEmpty()) {
+            ++skipped;
+            continue;
+        }
+        enqueueConversion(inputFile, outputFile);
+    }
     
-    bool success = fileConverter.convert(inputFile.toStdString(), outputFile.toStdString());
+    if (skipped > 0) {
+        ui->statusBar->showMessage(QString("Skipped %1 unsupported file(s)").arg(skipped), 5000);
+    }
+    event->acceptProposedAction();
+}
+
+void MainWindow::enqueueConversion(const QString& inputFile, const QString& outputFile)
+{
+    // A new run starts once the previous queue has drained
+    if (!conversionRunning && pendingConversions.isEmpty()) {
+        totalConversions = 0;
+        completedConversions = 0;
+        failedConversions = 0;
+    }
     
-    ui->convertButton->setEnabled(true);
+    pendingConversions.enqueue(qMakePair(inputFile, outputFile));
+    ++totalConversions;
+    ui->cancelButton->setEnabled(true);
     
-    if (success) {
-        ui->statusBar->showMessage("Conversion completed successfully", 5000);
-        QMessageBox::information(this, tr("Success"), tr("File conversion completed successfully."));
+    if (!conversionRunning) {
+        startNextConversion();
     } else {
-        ui->statusBar->showMessage("Conversion failed", 5000);
-        QMessageBox::critical(this, tr("Error"), tr("File conversion failed."));
+        ui->statusBar->showMessage(QString("Queued %1 (%2 waiting)")
+            .arg(QFileInfo(inputFile).fileName()).arg(pendingConversions.size()));
     }
 }
 
-void MainWindow::updateOutputFormats()
+void MainWindow::startNextConversion()
 {
-    // Get the selected input format
-    QString inputExtension = ui->inputFormatCombo->currentText();
+    if (pendingConversions.isEmpty()) {
+        return;
+    }
     
-    // Clear output format combo box
-    ui->outputFormatCombo->clear();
+    QPair<QString, QString> job = pendingConversions.dequeue();
+    conversionRunning = true;
+    fileConverter.resetCancel();
+    emit conversionRequested(job.first, job.second);
+}
+
+void MainWindow::onConversionStarted(const QString& inputFile)
+{
+    currentConversionName = QFileInfo(inputFile).fileName();
+    QString message = QString("Converting %1...").arg(currentConversionName);
+    if (!pendingConversions.isEmpty()) {
+        message += QString(" (%1 queued)").arg(pendingConversions.size());
+    }
+    ui->statusBar->showMessage(message);
+}
+
+void MainWindow::onConversionProgress(int percent, const QString& details)
+{
+    updateProgressBar(percent);
     
-    // Text formats
-    if (inputExtension == ".txt" || inputExtension == ".csv" || 
-        inputExtension == ".json" || inputExtension == ".xml" || 
-        inputExtension == ".html" || inputExtension == ".md") {
-        
-        if (inputExtension != ".txt") ui->outputFormatCombo->addItem(".txt");
-        if (inputExtension != ".csv") ui->outputFormatCombo->addItem(".csv");
-        if (inputExtension != ".json") ui->outputFormatCombo->addItem(".json");
-        if (inputExtension != ".xml") ui->outputFormatCombo->addItem(".xml");
-        if (inputExtension != ".html") ui->outputFormatCombo->addItem(".html");
-        if (inputExtension != ".md") ui->outputFormatCombo->addItem(".md");
+    if (!details.isEmpty()) {
+        ui->statusBar->showMessage(QString("Converting %1: %2% (%3)").arg(currentConversionName).arg(percent).arg(details));
+    }
+}
+
+void MainWindow::updateProgressBar(int currentPercent)
+{
+    if (totalConversions <= 0) {
+        ui->progressBar->setValue(0);
+        return;
     }
     
-    // Image formats
-    else if (inputExtension == ".jpg" || inputExtension == ".png" || 
-             inputExtension == ".gif" || inputExtension == ".bmp" ||
-             inputExtension == ".tiff" || inputExtension == ".webp" ||
-             inputExtension == ".svg" || inputExtension == ".ico") {
-        
-        if (inputExtension != ".jpg") ui->outputFormatCombo->addItem(".jpg");
-        if (inputExtension != ".png") ui->outputFormatCombo->addItem(".png");
-        if (inputExtension != ".gif") ui->outputFormatCombo->addItem(".gif");
-        if (inputExtension != ".bmp") ui->outputFormatCombo->addItem(".bmp");
-        if (inputExtension != ".tiff") ui->outputFormatCombo->addItem(".tiff");
-        if (inputExtension != ".webp") ui->outputFormatCombo->addItem(".webp");
-        if (inputExtension != ".svg") ui->outputFormatCombo->addItem(".svg");
-        if (inputExtension != ".ico") ui->outputFormatCombo->addItem(".ico");
+    // Overall progress of the queue, including the file being converted
+    ui->progressBar->setValue((completedConversions * 100 + currentPercent) / totalConversions);
+}
+
+void MainWindow::onConversionFinished(const QString& inputFile, const QString& outputFile, bool success, bool cancelled)
+{
+    Q_UNUSED(outputFile);
+    
+    conversionRunning = false;
+    ++completedConversions;
+    if (!success) {
+        ++failedConversions;
+    }
+    updateProgressBar(0);
+    
+    if (cancelled) {
+        // Anything after the cancelled file was dropped from the queue
+        fileConverter.resetCancel();
+        totalConversions = completedConversions;
+        ui->cancelButton->setEnabled(false);
+        ui->progressBar->setValue(0);
+        ui->statusBar->showMessage("Conversion cancelled", 5000);
+        return;
     }
     
-    // Video formats
-    else if (inputExtension == ".mp4" || inputExtension == ".avi" || 
-             inputExtension == ".mov" || inputExtension == ".mkv" ||
-             inputExtension == ".wmv" || inputExtension == ".flv" ||
-             inputExtension == ".webm" || inputExtension == ".m4v") {
-        
-        if (inputExtension != ".mp4") ui->outputFormatCombo->addItem(".mp4");
-        if (inputExtension != ".avi") ui->outputFormatCombo->addItem(".avi");
-        if (inputExtension != ".mov") ui->outputFormatCombo->addItem(".mov");
-        if (inputExtension != ".mkv") ui->outputFormatCombo->addItem(".mkv");
-        if (inputExtension != ".wmv") ui->outputFormatCombo->addItem(".wmv");
-        if (inputExtension != ".flv") ui->outputFormatCombo->addItem(".flv");
-        if (inputExtension != ".webm") ui->outputFormatCombo->addItem(".webm");
-        if (inputExtension != ".m4v") ui->outputFormatCombo->addItem(".m4v");
+    if (!pendingConversions.isEmpty()) {
+        ui->statusBar->showMessage(QString("%1 %2").arg(QFileInfo(inputFile).fileName(),
+            success ? "converted" : "failed"), 5000);
+        startNextConversion();
+        return;
     }
     
-    // Audio formats
-    else if (inputExtension == ".mp3" || inputExtension == ".wav" || 
-             inputExtension == ".aac" || inputExtension == ".flac" ||
-             inputExtension == ".ogg" || inputExtension == ".wma") {
-        
-        if (inputExtension != ".mp3") ui->outputFormatCombo->addItem(".mp3");
-        if (inputExtension != ".wav") ui->outputFormatCombo->addItem(".wav");
-        if (inputExtension != ".aac") ui->outputFormatCombo->addItem(".aac");
-        if (inputExtension != ".flac") ui->outputFormatCombo->addItem(".flac");
-        if (inputExtension != ".ogg") ui->outputFormatCombo->addItem(".ogg");
-        if (inputExtension != ".wma") ui->outputFormatCombo->addItem(".wma");
+    // Queue drained
+    ui->cancelButton->setEnabled(false);
+    
+    if (totalConversions == 1) {
+        if (success) {
+            ui->statusBar->showMessage("Conversion completed successfully", 5000);
+            QMessageBox::information(this, tr("Success"), tr("File conversion completed successfully."));
+        } else {
+            ui->statusBar->showMessage("Conversion failed", 5000);
+            QMessageBox::critical(this, tr("Error"), tr("File conversion failed."));
+        }
+        return;
     }
     
-    // Document formats
-    else if (inputExtension == ".pdf" || inputExtension == ".docx" || 
-             inputExtension == ".odt" || inputExtension == ".rtf") {
-        
-        if (inputExtension != ".pdf") ui->outputFormatCombo->addItem(".pdf");
-        if (inputExtension != ".docx") ui->outputFormatCombo->addItem(".docx");
-        if (inputExtension != ".odt") ui->outputFormatCombo->addItem(".odt");
-        if (inputExtension != ".rtf") ui->outputFormatCombo->addItem(".rtf");
+    QString summary = QString("%1 of %2 files converted").arg(totalConversions - failedConversions).arg(totalConversions);
+    ui->statusBar->showMessage(summary, 5000);
+    if (failedConversions == 0) {
+        QMessageBox::information(this, tr("Success"), summary + ".");
+    } else {
+        QMessageBox::critical(this, tr("Error"), summary + QString(", %1 failed.").arg(failedConversions));
+    }
+}
+
+void MainWindow::updateOutputFormats()
+{
+    // Get the selected input format
+    QString inputExtension = ui->inputFormatCombo->currentText();
+    
+    // Clear output format combo box
+    ui->outputFormatCombo->clear();
+    
+    // Offer every format the route table can reach from the input
+    converter::FileFormat inputFormat = converter::FileConverter::detectFormat(inputExtension.toStdString());
+    for (auto format : fileConverter.getSupportedOutputFormats(inputFormat)) {
+        ui->outputFormatCombo->addItem(QString::fromStdString(converter::FileConverter::getExtension(format)));
     }
     
     // Update output filename after changing format
@@ -249,6 +316,26 @@ QString MainWindow::getOutputFilePath()
     return QDir(outputFolder).filePath(outputFileName);
 }
 
+QString MainWindow::getOutputFilePathFor(const QString& inputFile)
+{
+    // Dropped files use the selected output format and folder (or their own folder)
+    QFileInfo fileInfo(inputFile);
+    QString outputFormat = ui->outputFormatCombo->currentText();
+    
+    converter::FileFormat input = converter::FileConverter::detectFormat(inputFile.toStdString());
+    converter::FileFormat output = converter::FileConverter::detectFormat(outputFormat.toStdString());
+    if (input == converter::FileFormat::UNKNOWN || output == converter::FileFormat::UNKNOWN || input == output) {
+        return "";
+    }
+    
+    QString outputFolder = ui->outputFolderEdit->text();
+    if (outputFolder.isEmpty()) {
+        outputFolder = fileInfo.absolutePath();
+    }
+    
+    return QDir(outputFolder).filePath(fileInfo.completeBaseName() + outputFormat);
+}
+
 QString MainWindow::getFileFilter(const QString& extension)
 {
     QString formatName = extension.mid(1).toUpper(); // Remove the dot and convert to uppercase
@@ -257,49 +344,26 @@ QString MainWindow::getFileFilter(const QString& extension)
 
 bool MainWindow::isConversionSupported(converter::FileFormat input, converter::FileFormat output)
 {
-    // Text formats
-    if ((input == converter::FileFormat::TXT || input == converter::FileFormat::CSV || 
-         input == converter::FileFormat::JSON || input == converter::FileFormat::XML) &&
-        (output == converter::FileFormat::TXT || output == converter::FileFormat::CSV || 
-         output == converter::FileFormat::JSON || output == converter::FileFormat::XML)) {
-        return true;
+    converter::Backend backend = converter::routeFor(input, output);
+    if (backend == converter::Backend::NONE) {
+        // Only an in-process converter can handle pairs outside the table
+        auto outputs = fileConverter.getSupportedOutputFormats(input);
+        return std::find(outputs.begin(), outputs.end(), output) != outputs.end();
     }
     
-    // For other formats, we'll need to check if the required dependencies are installed
-    // and handle the conversion through external tools
-    
-    // For now, let's assume all other conversions are handled by external tools
-    // if the dependencies are installed
-    return checkDependencies();
+    // Routed conversions need the backend's tool, unless an in-process converter covers the pair
+    const char* tool = converter::backendTool(backend);
+    return tool == nullptr || fileConverter.hasNativeConverter(input, output) ||
+           fileConverter.isToolAvailable(tool);
 }
 
 bool MainWindow::checkDependencies()
 {
-    bool imageMagickInstalled = false;
-    bool ffmpegInstalled = false;
-    bool pandocInstalled = false;
-    bool libreOfficeInstalled = false;
-    
-    // Check for ImageMagick
-    QProcess process;
-    process.start("magick", QStringList() << "-version");
-    process.waitForFinished();
-    imageMagickInstalled = (process.exitCode() == 0);
-    
-    // Check for FFmpeg
-    process.start("ffmpeg", QStringList() << "-version");
-    process.waitForFinished();
-    ffmpegInstalled = (process.exitCode() == 0);
-    
-    // Check for Pandoc
-    process.start("pandoc", QStringList() << "--version");
-    process.waitForFinished();
-    pandocInstalled = (process.exitCode() == 0);
-    
-    // Check for LibreOffice
-    process.start("soffice", QStringList() << "--version");
-    process.waitForFinished();
-    libreOfficeInstalled = (process.exitCode() == 0);
+    // Tool discovery is cached process-wide, so repeated checks don't spawn anything
+    bool imageMagickInstalled = fileConverter.isToolAvailable("magick");
+    bool ffmpegInstalled = fileConverter.isToolAvailable("ffmpeg");
+    bool pandocInstalled = fileConverter.isToolAvailable("pandoc");
+    bool libreOfficeInstalled = fileConverter.isToolAvailable("soffice");
     
     // Update warning label
     QStringList missingDeps;
@@ -3,8 +3,15 @@
 
 #include <QMainWindow>
 #include <QProcess>
+#include <QThread>
+#include <QQueue>
+#include <QPair>
 #include "../include/FileConverter.h"
 
+class ConversionWorker;
+class QDragEnterEvent;
+class QDropEvent;
+
 namespace Ui {
 class MainWindow;
 }
@@ -17,10 +24,21 @@ public:
     explicit MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+signals:
+    void conversionRequested(const QString& inputFile, const QString& outputFile);
+
+protected:
+    void dragEnterEvent(QDragEnterEvent *event) override;
+    void dropEvent(QDropEvent *event) override;
+
 private slots:
     void on_browseInputButton_clicked();
     void on_browseOutputFolderButton_clicked(); // Changed from browseOutputButton
     void on_convertButton_clicked();
+    void on_cancelButton_clicked();
+    void onConversionStarted(const QString& inputFile);
+    void onConversionProgress(int percent, const QString& details);
+    void onConversionFinished(const QString& inputFile, const QString& outputFile, bool success, bool cancelled);
     void updateOutputFormats();
     void updateOutputFileName(); // New function to update output filename
     void on_actionInstallDependencies_triggered();
@@ -38,6 +56,20 @@ private:
     void setDarkMode();
     void setLightMode();
     bool isDarkMode;
+    
+    // Background conversion queue
+    void enqueueConversion(const QString& inputFile, const QString& outputFile);
+    void startNextConversion();
+    void updateProgressBar(int currentPercent);
+    QString getOutputFilePathFor(const QString& inputFile);
+    QThread workerThread;
+    ConversionWorker *worker;
+    QQueue<QPair<QString, QString>> pendingConversions;
+    bool conversionRunning;
+    QString currentConversionName;
+    int totalConversions;
+    int completedConversions;
+    int failedConversions;
 };
 
 #endif // MAINWINDOW_H
\ No newline at end of file
@@ -0,0 +1,149 @@
+#include "MappedFile.h"
+#include <algorithm>
+#include <cstdint>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace converter {
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& path, Mode mode) {
+    close();
+    
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0 ||
+        static_cast<unsigned long long>(fileSize.QuadPart) > SIZE_MAX) {
+        CloseHandle(file);
+        return false;
+    }
+    
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+    if (!mapping) {
+        CloseHandle(file);
+        return false;
+    }
+    
+    DWORD access = (mode == Mode::COPY_ON_WRITE) ? FILE_MAP_COPY : FILE_MAP_READ;
+    void* view = MapViewOfFile(mapping, access, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    
+    fileHandle_ = file;
+    mappingHandle_ = mapping;
+    data_ = static_cast<char*>(view);
+    size_ = static_cast<std::size_t>(fileSize.QuadPart);
+    return true;
+}
+
+void MappedFile::close() {
+    if (data_) {
+        UnmapViewOfFile(data_);
+    }
+    if (mappingHandle_) {
+        CloseHandle(mappingHandle_);
+    }
+    if (fileHandle_) {
+        CloseHandle(fileHandle_);
+    }
+    data_ = nullptr;
+    size_ = 0;
+    mappingHandle_ = nullptr;
+    fileHandle_ = nullptr;
+}
+
+void MappedFile::adviseSequential() {
+    // FILE_FLAG_SEQUENTIAL_SCAN already requested read-ahead when opening
+}
+
+void MappedFile::adviseDone(std::size_t, std::size_t) {
+    // No portable equivalent; the working set is trimmed by the memory manager
+}
+
+#else
+
+bool MappedFile::open(const std::string& path, Mode mode) {
+    close();
+    
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size <= 0 ||
+        static_cast<std::uintmax_t>(info.st_size) > SIZE_MAX) {
+        ::close(fd);
+        return false;
+    }
+    
+    std::size_t length = static_cast<std::size_t>(info.st_size);
+    int protection = (mode == Mode::COPY_ON_WRITE) ? (PROT_READ | PROT_WRITE) : PROT_READ;
+    void* address = mmap(nullptr, length, protection, MAP_PRIVATE, fd, 0);
+    
+    // The mapping keeps its own reference to the file
+    ::close(fd);
+    
+    if (address == MAP_FAILED) {
+        return false;
+    }
+    
+    data_ = static_cast<char*>(address);
+    size_ = length;
+    return true;
+}
+
+void MappedFile::close() {
+    if (data_) {
+        munmap(data_, size_);
+    }
+    data_ = nullptr;
+    size_ = 0;
+}
+
+void MappedFile::adviseSequential() {
+    if (data_) {
+        madvise(data_, size_, MADV_SEQUENTIAL);
+    }
+}
+
+void MappedFile::adviseDone(std::size_t offset, std::size_t length) {
+    if (!data_ || offset >= size_) {
+        return;
+    }
+    
+    // madvise needs a page-aligned start; round inwards so live data is never dropped
+    std::size_t pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    std::size_t begin = (offset + pageSize - 1) / pageSize * pageSize;
+    std::size_t end = std::min(offset + length, size_) / pageSize * pageSize;
+    if (end > begin) {
+        madvise(data_ + begin, end - begin, MADV_DONTNEED);
+    }
+}
+
+#endif
+
+} // namespace converter
@@ -0,0 +1,284 @@
+#include "OfficeWorkerPool.h"
+#include <QDir>
+#include <QFile>
+#include <QProcess>
+#include <QString>
+#include <QUrl>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+namespace converter {
+
+namespace {
+
+// How long a fresh instance may take to create its profile and IPC pipe
+constexpr int kStartupTimeoutMs = 60000;
+constexpr int kStartupPollMs = 100;
+
+// Give up on a worker that keeps crashing instead of restarting forever
+constexpr int kMaxRestarts = 5;
+
+// How long an instance may take to exit after SIGTERM before it is killed
+constexpr int kShutdownTimeoutMs = 10000;
+
+bool processAlive(long long pid) {
+    if (pid <= 0) {
+        return false;
+    }
+#ifdef _WIN32
+    HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, static_cast<DWORD>(pid));
+    if (!process) {
+        return false;
+    }
+    DWORD exitCode = 0;
+    bool alive = GetExitCodeProcess(process, &exitCode) && exitCode == STILL_ACTIVE;
+    CloseHandle(process);
+    return alive;
+#else
+    return ::kill(static_cast<pid_t>(pid), 0) == 0;
+#endif
+}
+
+// Process group of a detached process, or 0 if it shares ours. startDetached
+// runs the tool as a grandchild of an intermediate process that called
+// setsid(), so the group is that process's id, not the pid it returns.
+long long processGroupOf(long long pid) {
+#ifdef _WIN32
+    (void)pid;
+    return 0;
+#else
+    pid_t group = ::getpgid(static_cast<pid_t>(pid));
+    return (group > 0 && group != ::getpgrp()) ? static_cast<long long>(group) : 0;
+#endif
+}
+
+// Whether the process, or any process left in its group, is still running
+bool treeAlive(long long pid, long long group) {
+#ifndef _WIN32
+    if (group > 0 && ::kill(static_cast<pid_t>(-group), 0) == 0) {
+        return true;
+    }
+#else
+    (void)group;
+#endif
+    return processAlive(pid);
+}
+
+void signalTree(long long pid, long long group, bool force) {
+#ifdef _WIN32
+    (void)group;
+    (void)force;
+    // soffice.exe starts soffice.bin as a child; take the whole tree down
+    QProcess::execute("taskkill", QStringList() << "/PID" << QString::number(pid) << "/T" << "/F");
+#else
+    int signal = force ? SIGKILL : SIGTERM;
+    // The group holds the soffice wrapper and soffice.bin
+    if (group > 0) {
+        ::kill(static_cast<pid_t>(-group), signal);
+    }
+    if (pid > 0) {
+        ::kill(static_cast<pid_t>(pid), signal);
+    }
+#endif
+}
+
+bool waitForExit(long long pid, long long group, int timeoutMs) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (treeAlive(pid, group)) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(kStartupPollMs));
+    }
+    return true;
+}
+
+// Stops the wrapper and soffice.bin, escalating to SIGKILL; true once all exited
+bool terminateProcessTree(long long pid, long long group) {
+    if (pid <= 0 && group <= 0) {
+        return true;
+    }
+    signalTree(pid, group, false);
+    if (waitForExit(pid, group, kShutdownTimeoutMs)) {
+        return true;
+    }
+    signalTree(pid, group, true);
+    return waitForExit(pid, group, kShutdownTimeoutMs);
+}
+
+} // namespace
+
+OfficeWorkerPool::Lease::~Lease() {
+    if (pool_) {
+        pool_->release(slot_);
+    }
+}
+
+OfficeWorkerPool::Lease::Lease(Lease&& other) noexcept : pool_(other.pool_), slot_(other.slot_) {
+    other.pool_ = nullptr;
+}
+
+QStringList OfficeWorkerPool::Lease::arguments() const {
+    return QStringList() << ("-env:UserInstallation=" + profileUrl(pool_->workers_[slot_]));
+}
+
+bool OfficeWorkerPool::Lease::isHealthy() const {
+    return pool_->isRunning(pool_->workers_[slot_]);
+}
+
+bool OfficeWorkerPool::Lease::restart() {
+    // The slot is leased to us, so nobody else touches this worker
+    return pool_->ensureRunning(pool_->workers_[slot_]);
+}
+
+OfficeWorkerPool::OfficeWorkerPool(const std::string& sofficePath, std::size_t workerCount)
+    : sofficePath_(sofficePath),
+      baseDir_(QDir(QDir::tempPath()).filePath("fileconverter-office-XXXXXX")) {
+    if (workerCount == 0) {
+        workerCount = 1;
+    }
+    if (!baseDir_.isValid()) {
+        std::cerr << "Cannot create a directory for LibreOffice worker profiles" << std::endl;
+    }
+    
+    workers_.resize(workerCount);
+    for (std::size_t i = 0; i < workerCount; ++i) {
+        workers_[i].profileDir = QDir(baseDir_.path()).filePath(QString("worker-%1").arg(static_cast<int>(i))).toStdString();
+    }
+}
+
+OfficeWorkerPool::~OfficeWorkerPool() {
+    bool stopped = true;
+    for (Worker& worker : workers_) {
+        stopped = stopWorker(worker) && stopped;
+    }
+    // Never pull the profile out from under an instance that is still running
+    baseDir_.setAutoRemove(stopped);
+}
+
+OfficeWorkerPool::Lease OfficeWorkerPool::acquire() {
+    std::size_t slot = 0;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        workerAvailable_.wait(lock, [this, &slot] {
+            for (std::size_t i = 0; i < workers_.size(); ++i) {
+                if (!workers_[i].busy) {
+                    slot = i;
+                    return true;
+                }
+            }
+            return false;
+        });
+        workers_[slot].busy = true;
+    }
+    
+    // Start or revive the instance outside the lock; other slots stay usable
+    ensureRunning(workers_[slot]);
+    return Lease(this, slot);
+}
+
+void OfficeWorkerPool::release(std::size_t slot) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        workers_[slot].busy = false;
+    }
+    workerAvailable_.notify_one();
+}
+
+bool OfficeWorkerPool::ensureRunning(Worker& worker) {
+    if (isRunning(worker)) {
+        return true;
+    }
+    
+    if (worker.pid != 0) {
+        if (worker.restarts >= kMaxRestarts) {
+            return false;
+        }
+        std::cerr << "LibreOffice worker stopped, restarting..." << std::endl;
+        ++worker.restarts;
+        // A new instance on a profile still in use would just attach to the old one
+        if (!stopWorker(worker)) {
+            std::cerr << "LibreOffice worker does not exit, not restarting it" << std::endl;
+            return false;
+        }
+    }
+    
+    return startWorker(worker);
+}
+
+bool OfficeWorkerPool::startWorker(Worker& worker) {
+    if (!baseDir_.isValid()) {
+        return false;
+    }
+    QDir().mkpath(QString::fromStdString(worker.profileDir));
+    
+    QStringList args;
+    args << ("-env:UserInstallation=" + profileUrl(worker))
+         << "--headless"
+         << "--invisible"
+         << "--nologo"
+         << "--nodefault"
+         << "--norestore"
+         << QString("--accept=pipe,name=%1-%2;urp;")
+                .arg(QDir(baseDir_.path()).dirName())
+                .arg(QDir(QString::fromStdString(worker.profileDir)).dirName());
+    
+    qint64 pid = 0;
+    if (!QProcess::startDetached(QString::fromStdString(sofficePath_), args, QString(), &pid)) {
+        std::cerr << "Failed to start LibreOffice worker" << std::endl;
+        return false;
+    }
+    worker.pid = pid;
+    worker.processGroup = processGroupOf(pid);
+    
+    // The instance is ready once it has locked its profile
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(kStartupTimeoutMs);
+    while (std::chrono::steady_clock::now() < deadline) {
+        if (isRunning(worker)) {
+            return true;
+        }
+        if (!processAlive(worker.pid)) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(kStartupPollMs));
+    }
+    
+    std::cerr << "LibreOffice worker did not come up" << std::endl;
+    stopWorker(worker);
+    return false;
+}
+
+bool OfficeWorkerPool::stopWorker(Worker& worker) {
+    if (!terminateProcessTree(worker.pid, worker.processGroup)) {
+        std::cerr << "LibreOffice worker " << worker.pid << " did not exit" << std::endl;
+        return false;
+    }
+    worker.pid = 0;
+    worker.processGroup = 0;
+    
+    // A killed instance leaves its lock behind; remove it so the profile can be reused
+    QFile::remove(QDir(QString::fromStdString(worker.profileDir)).filePath(".lock"));
+    return true;
+}
+
+bool OfficeWorkerPool::isRunning(const Worker& worker) const {
+    return processAlive(worker.pid) &&
+           QFile::exists(QDir(QString::fromStdString(worker.profileDir)).filePath(".lock"));
+}
+
+QString OfficeWorkerPool::profileUrl(const Worker& worker) {
+    return QUrl::fromLocalFile(QString::fromStdString(worker.profileDir)).toString();
+}
+
+} // namespace converter
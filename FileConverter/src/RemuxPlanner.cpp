@@ -0,0 +1,163 @@
+#include "RemuxPlanner.h"
+#include <sstream>
+
+namespace converter {
+
+namespace {
+
+// Codecs each container takes without re-encoding. Entries ending in '*' match
+// by prefix. Matroska holds practically anything and is handled separately.
+const std::vector<std::string>& containerCodecs(FileFormat container) {
+    static const std::vector<std::string> kNone;
+    static const std::vector<std::string> kMp4 = {
+        "h264", "hevc", "mpeg4", "av1", "vp9", "aac", "mp3", "ac3", "eac3", "alac", "opus", "mov_text"
+    };
+    static const std::vector<std::string> kM4v = {
+        "h264", "hevc", "mpeg4", "aac", "ac3", "eac3", "alac", "mov_text"
+    };
+    static const std::vector<std::string> kMov = {
+        "h264", "hevc", "mpeg4", "prores", "mjpeg", "aac", "mp3", "ac3", "eac3", "alac", "pcm_s16le",
+        "pcm_s24le", "mov_text"
+    };
+    static const std::vector<std::string> kWebm = {"vp8", "vp9", "av1", "vorbis", "opus", "webvtt"};
+    static const std::vector<std::string> kAvi = {"mpeg4", "msmpeg4v2", "msmpeg4v3", "mjpeg", "mp3", "ac3", "pcm_s16le"};
+    static const std::vector<std::string> kFlv = {"h264", "flv1", "aac", "mp3"};
+    static const std::vector<std::string> kAsf = {"wmv1", "wmv2", "wmv3", "vc1", "wmav1", "wmav2", "wmapro"};
+    static const std::vector<std::string> kMp3 = {"mp3"};
+    static const std::vector<std::string> kAac = {"aac"};
+    static const std::vector<std::string> kFlac = {"flac"};
+    static const std::vector<std::string> kOgg = {"vorbis", "opus", "flac"};
+    static const std::vector<std::string> kWav = {"pcm_*"};
+    static const std::vector<std::string> kWma = {"wmav1", "wmav2", "wmapro"};
+
+    switch (container) {
+        case FileFormat::MP4: return kMp4;
+        case FileFormat::M4V: return kM4v;
+        case FileFormat::MOV: return kMov;
+        case FileFormat::WEBM: return kWebm;
+        case FileFormat::AVI: return kAvi;
+        case FileFormat::FLV: return kFlv;
+        case FileFormat::WMV: return kAsf;
+        case FileFormat::MP3: return kMp3;
+        case FileFormat::AAC: return kAac;
+        case FileFormat::FLAC: return kFlac;
+        case FileFormat::OGG: return kOgg;
+        case FileFormat::WAV: return kWav;
+        case FileFormat::WMA: return kWma;
+        default: return kNone;
+    }
+}
+
+bool isMediaFormat(FileFormat format) {
+    FormatCategory category = categoryOf(format);
+    return category == FormatCategory::VIDEO || category == FormatCategory::AUDIO;
+}
+
+} // namespace
+
+std::vector<std::string> probeArguments(const std::string& inputFile) {
+    return {"-v", "error", "-show_entries", "stream=codec_type,codec_name", "-of", "compact=p=0", inputFile};
+}
+
+std::vector<MediaStream> parseProbeStreams(const std::string& output) {
+    std::vector<MediaStream> streams;
+    std::istringstream lines(output);
+    std::string line;
+    while (std::getline(lines, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+
+        MediaStream stream;
+        std::istringstream fields(line);
+        std::string field;
+        while (std::getline(fields, field, '|')) {
+            std::size_t equals = field.find('=');
+            if (equals == std::string::npos) {
+                continue;
+            }
+            std::string key = field.substr(0, equals);
+            if (key == "codec_type") {
+                stream.type = field.substr(equals + 1);
+            } else if (key == "codec_name") {
+                stream.codec = field.substr(equals + 1);
+            }
+        }
+        if (!stream.type.empty()) {
+            streams.push_back(stream);
+        }
+    }
+    return streams;
+}
+
+bool containerAccepts(FileFormat container, const std::string& codec) {
+    if (codec.empty()) {
+        return false;
+    }
+    if (container == FileFormat::MKV) {
+        return true;
+    }
+    for (const std::string& accepted : containerCodecs(container)) {
+        if (accepted.back() == '*' ? codec.compare(0, accepted.size() - 1, accepted, 0, accepted.size() - 1) == 0
+                                   : codec == accepted) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool mayStreamCopy(FileFormat input, FileFormat output) {
+    if (!isMediaFormat(input) || !isMediaFormat(output)) {
+        return false;
+    }
+    if (input == FileFormat::MKV || output == FileFormat::MKV) {
+        return true;
+    }
+    for (const std::string& codec : containerCodecs(input)) {
+        // A prefix entry is checked with its most common codec
+        if (codec.back() == '*' ? containerAccepts(output, codec.substr(0, codec.size() - 1) + "s16le")
+                                : containerAccepts(output, codec)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool canStreamCopy(const std::vector<MediaStream>& streams, FileFormat output, std::string* reason) {
+    bool audioOutput = categoryOf(output) == FormatCategory::AUDIO;
+    std::size_t copied = 0;
+    for (const MediaStream& stream : streams) {
+        // FFmpeg maps no data or attachment streams by default
+        bool mapped = stream.type == "audio" ||
+                      (!audioOutput && (stream.type == "video" || stream.type == "subtitle"));
+        if (!mapped) {
+            continue;
+        }
+        if (!containerAccepts(output, stream.codec)) {
+            if (reason) {
+                *reason = stream.type + " stream " + (stream.codec.empty() ? "of unknown codec" : stream.codec) +
+                          " needs encoding";
+            }
+            return false;
+        }
+        ++copied;
+    }
+
+    if (copied == 0) {
+        if (reason) {
+            *reason = audioOutput ? "no audio stream" : "no streams to copy";
+        }
+        return false;
+    }
+    return true;
+}
+
+std::vector<std::string> streamCopyOptions(FileFormat output) {
+    if (categoryOf(output) == FormatCategory::AUDIO) {
+        // Cover art and subtitles of the source are left out
+        return {"-vn", "-sn", "-dn", "-c", "copy"};
+    }
+    return {"-c", "copy"};
+}
+
+} // namespace converter
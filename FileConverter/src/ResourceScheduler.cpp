@@ -0,0 +1,100 @@
+#include "ResourceScheduler.h"
+#include "ThreadPool.h"
+#include <algorithm>
+
+namespace converter {
+
+namespace {
+
+// Video encoders rarely gain beyond this many threads per stream
+constexpr std::size_t kMaxHeavyThreads = 8;
+
+std::size_t costIndex(CostClass cost) {
+    return static_cast<std::size_t>(cost);
+}
+
+} // namespace
+
+CostClass costClassFor(Backend backend, FileFormat outputFormat) {
+    switch (backend) {
+        case Backend::FFMPEG:
+            // Audio encoders are single-threaded; anything producing video is not
+            return categoryOf(outputFormat) == FormatCategory::VIDEO ? CostClass::HEAVY : CostClass::LIGHT;
+        case Backend::IMAGEMAGICK:
+        case Backend::LIBREOFFICE:
+            return CostClass::MEDIUM;
+        case Backend::NATIVE:
+        case Backend::PANDOC:
+        case Backend::NONE:
+            break;
+    }
+    return CostClass::LIGHT;
+}
+
+const char* costClassName(CostClass cost) {
+    switch (cost) {
+        case CostClass::LIGHT: return "light";
+        case CostClass::MEDIUM: return "medium";
+        case CostClass::HEAVY: return "heavy";
+    }
+    return "unknown";
+}
+
+ResourceScheduler::Lease::~Lease() {
+    if (scheduler_) {
+        scheduler_->release(threads_);
+    }
+}
+
+ResourceScheduler::Lease::Lease(Lease&& other) noexcept : scheduler_(other.scheduler_), threads_(other.threads_) {
+    other.scheduler_ = nullptr;
+}
+
+ResourceScheduler::ResourceScheduler(std::size_t cores)
+    : cores_(cores > 0 ? cores : ThreadPool::defaultThreadCount()) {
+    budgets_[costIndex(CostClass::LIGHT)] = 1;
+    budgets_[costIndex(CostClass::MEDIUM)] = std::min<std::size_t>(2, cores_);
+    budgets_[costIndex(CostClass::HEAVY)] =
+        std::min(cores_, std::min(kMaxHeavyThreads, std::max<std::size_t>(2, cores_ / 2)));
+}
+
+void ResourceScheduler::setThreadBudget(CostClass cost, std::size_t threads) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    budgets_[costIndex(cost)] = std::max<std::size_t>(1, std::min(threads, cores_));
+}
+
+std::size_t ResourceScheduler::threadBudget(CostClass cost) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return budgets_[costIndex(cost)];
+}
+
+ResourceScheduler::Lease ResourceScheduler::acquire(CostClass cost) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::size_t threads = budgets_[costIndex(cost)];
+    std::uint64_t ticket = nextTicket_++;
+    released_.wait(lock, [this, ticket, threads] {
+        return ticket == servingTicket_ && inUse_ + threads <= cores_;
+    });
+    inUse_ += threads;
+    ++servingTicket_;
+    lock.unlock();
+
+    // The next request in line may fit into what is left
+    released_.notify_all();
+    return Lease(this, threads);
+}
+
+std::size_t ResourceScheduler::inUse() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return inUse_;
+}
+
+void ResourceScheduler::release(std::size_t threads) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        inUse_ -= threads;
+    }
+    released_.notify_all();
+}
+
+} // namespace converter
@@ -0,0 +1,702 @@
+#include "StructuredData.h"
+#include "CsvReader.h"
+#include "JsonReader.h"
+#include "XmlReader.h"
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace converter {
+
+namespace {
+
+// Output is written in blocks of this size (64 KiB)
+constexpr std::size_t kStructuredWriteSize = 1 << 16;
+
+// Deeper XML elements are rejected rather than converted recursively
+constexpr std::size_t kMaxXmlDepth = 512;
+
+const char* const kXmlDeclaration = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+
+using Writer = std::function<bool(std::istream& input, std::ostream& output, std::string& error)>;
+
+// Opens both files, runs 'write' and removes the output again if it fails
+bool convertFile(const std::string& inputPath, const std::string& outputPath, std::string* error,
+                 const Writer& write) {
+    std::ifstream input(inputPath, std::ios::binary);
+    if (!input) {
+        if (error) *error = "cannot open " + inputPath;
+        return false;
+    }
+
+    std::string message;
+    bool ok;
+    {
+        std::ofstream output(outputPath, std::ios::binary);
+        if (!output) {
+            if (error) *error = "cannot create " + outputPath;
+            return false;
+        }
+        ok = write(input, output, message);
+        output.flush();
+        if (ok && !output) {
+            ok = false;
+            message = "cannot write " + outputPath;
+        }
+    }
+
+    if (!ok) {
+        std::remove(outputPath.c_str());
+        if (error) *error = message;
+    }
+    return ok;
+}
+
+void flushIfFull(std::ostream& output, std::string& buffer) {
+    if (buffer.size() >= kStructuredWriteSize) {
+        output.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+    }
+}
+
+void flushAll(std::ostream& output, std::string& buffer) {
+    output.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    buffer.clear();
+}
+
+bool isBlank(const std::string& text) {
+    return text.find_first_not_of(" \t\r\n") == std::string::npos;
+}
+
+// Column names in first-seen order
+class ColumnSet {
+public:
+    std::size_t add(const std::string& name) {
+        auto it = index_.find(name);
+        if (it != index_.end()) {
+            return it->second;
+        }
+        index_.emplace(name, names_.size());
+        names_.push_back(name);
+        return names_.size() - 1;
+    }
+
+    std::size_t find(const std::string& name) const {
+        auto it = index_.find(name);
+        return it != index_.end() ? it->second : names_.size();
+    }
+
+    const std::vector<std::string>& names() const { return names_; }
+
+private:
+    std::vector<std::string> names_;
+    std::unordered_map<std::string, std::size_t> index_;
+};
+
+using FieldCallback = std::function<void(const std::string& column, const std::string& value)>;
+using RecordCallback = std::function<void()>;
+
+// --- CSV ---
+
+// Header names, with generated names for empty and missing columns
+std::string csvColumnName(const std::vector<std::string>& header, std::size_t index) {
+    if (index < header.size() && !header[index].empty()) {
+        return header[index];
+    }
+    return "column" + std::to_string(index + 1);
+}
+
+bool readCsvRecords(std::istream& input, std::string& error, const FieldCallback& onField,
+                    const RecordCallback& onRecord) {
+    CsvReader reader(input);
+    std::vector<std::string> header;
+    std::vector<std::string> fields;
+
+    if (!reader.next(header)) {
+        error = reader.error();
+        return error.empty();
+    }
+    while (reader.next(fields)) {
+        for (std::size_t i = 0; i < fields.size(); ++i) {
+            onField(csvColumnName(header, i), fields[i]);
+        }
+        onRecord();
+    }
+    error = reader.error();
+    return error.empty();
+}
+
+// --- JSON ---
+
+// Walks an array of objects (or a single object or value), reporting each
+// member as a field. Nested values are reported as compact JSON.
+bool readJsonRecords(std::istream& input, std::string& error, const FieldCallback& onField,
+                     const RecordCallback& onRecord) {
+    using Token = JsonReader::Token;
+
+    JsonReader reader(input);
+    std::string value;
+
+    auto cell = [&](Token token) {
+        value.clear();
+        switch (token) {
+            case Token::STRING:
+            case Token::NUMBER: value = reader.text(); return true;
+            case Token::TRUE_VALUE: value = "true"; return true;
+            case Token::FALSE_VALUE: value = "false"; return true;
+            case Token::NULL_VALUE: return true;
+            default: return appendJsonValue(reader, token, value);
+        }
+    };
+
+    // One record: the members of an object, or a lone value
+    auto record = [&](Token token) {
+        if (token != Token::BEGIN_OBJECT) {
+            if (!cell(token)) {
+                return false;
+            }
+            onField("value", value);
+            onRecord();
+            return true;
+        }
+        for (token = reader.next(); token == Token::KEY; token = reader.next()) {
+            std::string key = reader.text();
+            if (!cell(reader.next())) {
+                return false;
+            }
+            onField(key, value);
+        }
+        if (token != Token::END_OBJECT) {
+            return false;
+        }
+        onRecord();
+        return true;
+    };
+
+    Token token = reader.next();
+    bool ok;
+    if (token == Token::BEGIN_ARRAY) {
+        ok = true;
+        for (token = reader.next(); ok && token != Token::END_ARRAY && token != Token::ERROR; token = reader.next()) {
+            ok = record(token);
+        }
+        ok = ok && token == Token::END_ARRAY;
+    } else {
+        ok = token != Token::ERROR && record(token);
+    }
+
+    if (ok && reader.next() == Token::END) {
+        return true;
+    }
+    error = reader.error().empty() ? "unexpected JSON structure" : reader.error();
+    return false;
+}
+
+// --- XML ---
+
+// Walks the children of the root element as records. Attributes of a record
+// and the text of its child elements are reported as fields; a record with
+// neither reports its own text under its element name.
+bool readXmlRecords(std::istream& input, std::string& error, const FieldCallback& onField,
+                    const RecordCallback& onRecord) {
+    using Token = XmlReader::Token;
+
+    XmlReader reader(input);
+    std::string recordName;
+    std::string recordText;
+    std::string column;
+    std::string value;
+    bool recordHasFields = false;
+
+    for (Token token = reader.next(); token != Token::END; token = reader.next()) {
+        std::size_t depth = reader.depth();
+        switch (token) {
+            case Token::ERROR:
+                error = reader.error();
+                return false;
+
+            case Token::START_ELEMENT:
+                if (depth == 2) {
+                    recordName = reader.name();
+                    recordText.clear();
+                    recordHasFields = !reader.attributes().empty();
+                    for (const auto& attribute : reader.attributes()) {
+                        onField(attribute.first, attribute.second);
+                    }
+                } else if (depth == 3) {
+                    column = reader.name();
+                    value.clear();
+                    recordHasFields = true;
+                }
+                break;
+
+            case Token::TEXT:
+                if (depth == 2) {
+                    recordText += reader.text();
+                } else if (depth >= 3) {
+                    value += reader.text();
+                }
+                break;
+
+            case Token::END_ELEMENT:
+                if (depth == 2) {
+                    onField(column, value);
+                } else if (depth == 1) {
+                    if (!recordHasFields && !isBlank(recordText)) {
+                        onField(recordName, recordText);
+                    }
+                    onRecord();
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+    return true;
+}
+
+// Element tree of one XML record
+struct XmlNode {
+    std::string name;
+    XmlReader::Attributes attributes;
+    std::string text;
+    std::vector<XmlNode> children;
+};
+
+// Reads the element whose START_ELEMENT was just returned by 'reader'
+bool readXmlNode(XmlReader& reader, XmlNode& node, std::string& error) {
+    using Token = XmlReader::Token;
+
+    std::vector<XmlNode> stack;
+    stack.push_back(XmlNode{reader.name(), reader.attributes(), std::string(), {}});
+
+    while (!stack.empty()) {
+        Token token = reader.next();
+        switch (token) {
+            case Token::START_ELEMENT:
+                if (reader.depth() > kMaxXmlDepth) {
+                    error = "XML nesting deeper than " + std::to_string(kMaxXmlDepth) + " levels";
+                    return false;
+                }
+                stack.push_back(XmlNode{reader.name(), reader.attributes(), std::string(), {}});
+                break;
+            case Token::TEXT:
+                stack.back().text += reader.text();
+                break;
+            case Token::END_ELEMENT: {
+                XmlNode done = std::move(stack.back());
+                stack.pop_back();
+                // Line breaks and indentation in an element without children
+                // are layout (an empty object or array), not a value
+                if (done.children.empty() && isBlank(done.text) &&
+                    done.text.find('\n') != std::string::npos) {
+                    done.text.clear();
+                }
+                if (stack.empty()) {
+                    node = std::move(done);
+                } else {
+                    stack.back().children.push_back(std::move(done));
+                }
+                break;
+            }
+            default:
+                error = reader.error().empty() ? "unexpected end of XML" : reader.error();
+                return false;
+        }
+    }
+    return true;
+}
+
+bool allChildrenNamed(const XmlNode& node, const std::string& name) {
+    for (const XmlNode& child : node.children) {
+        if (child.name != name) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Text-only elements become strings; "item" children an array; anything else
+// an object with "@attribute" members, one member per child name (an array
+// when the name repeats) and "#text" for mixed content
+void appendXmlNodeJson(const XmlNode& node, std::string& out) {
+    if (node.attributes.empty() && node.children.empty()) {
+        appendJsonString(out, node.text);
+        return;
+    }
+
+    if (node.attributes.empty() && allChildrenNamed(node, "item")) {
+        out += '[';
+        for (std::size_t i = 0; i < node.children.size(); ++i) {
+            if (i > 0) out += ',';
+            appendXmlNodeJson(node.children[i], out);
+        }
+        out += ']';
+        return;
+    }
+
+    out += '{';
+    bool first = true;
+    auto member = [&](const std::string& key) {
+        if (!first) out += ',';
+        first = false;
+        appendJsonString(out, key);
+        out += ':';
+    };
+
+    for (const auto& attribute : node.attributes) {
+        member("@" + attribute.first);
+        appendJsonString(out, attribute.second);
+    }
+
+    std::vector<std::string> names;
+    std::unordered_map<std::string, std::vector<const XmlNode*>> groups;
+    for (const XmlNode& child : node.children) {
+        auto& group = groups[child.name];
+        if (group.empty()) {
+            names.push_back(child.name);
+        }
+        group.push_back(&child);
+    }
+    for (const std::string& name : names) {
+        const auto& group = groups[name];
+        member(name);
+        if (group.size() == 1) {
+            appendXmlNodeJson(*group.front(), out);
+            continue;
+        }
+        out += '[';
+        for (std::size_t i = 0; i < group.size(); ++i) {
+            if (i > 0) out += ',';
+            appendXmlNodeJson(*group[i], out);
+        }
+        out += ']';
+    }
+
+    if (!isBlank(node.text)) {
+        member("#text");
+        appendJsonString(out, node.text);
+    }
+    out += '}';
+}
+
+// --- Record writers ---
+
+// Writes records as CSV. Rows are written as they are read, under the columns
+// seen so far; only when a later record brings a new column is the input read
+// a second time with the union of all columns.
+bool writeCsv(const std::string& inputPath, std::ostream& output, std::string& error,
+              bool (*readRecords)(std::istream&, std::string&, const FieldCallback&, const RecordCallback&)) {
+    ColumnSet columns;
+    std::string buffer;
+    std::vector<std::string> row;
+    bool headerWritten = false;
+    bool consistent = true;
+
+    auto clearRow = [&]() {
+        for (std::string& cell : row) {
+            cell.clear();
+        }
+    };
+    auto onField = [&](const std::string& column, const std::string& value) {
+        std::size_t index = columns.add(column);
+        if (!consistent) {
+            return;
+        }
+        if (index >= row.size()) {
+            if (headerWritten) {
+                // The header is out already; keep collecting columns only
+                consistent = false;
+                return;
+            }
+            row.resize(index + 1);
+        }
+        row[index] = value;
+    };
+    auto onRecord = [&]() {
+        if (!consistent) {
+            return;
+        }
+        if (!headerWritten) {
+            appendCsvRecord(buffer, columns.names());
+            headerWritten = true;
+        }
+        appendCsvRecord(buffer, row);
+        clearRow();
+        flushIfFull(output, buffer);
+    };
+    {
+        std::ifstream input(inputPath, std::ios::binary);
+        if (!readRecords(input, error, onField, onRecord)) {
+            return false;
+        }
+    }
+    if (consistent) {
+        if (!headerWritten) {
+            appendCsvRecord(buffer, columns.names());
+        }
+        flushAll(output, buffer);
+        return true;
+    }
+
+    // New columns come last, so every line of the second pass is at least as
+    // long as the one it replaces and the first pass is overwritten entirely
+    buffer.clear();
+    output.seekp(0);
+    appendCsvRecord(buffer, columns.names());
+    row.assign(columns.names().size(), std::string());
+
+    std::ifstream input(inputPath, std::ios::binary);
+    auto onSecondField = [&](const std::string& column, const std::string& value) {
+        std::size_t index = columns.find(column);
+        if (index < row.size()) {
+            row[index] = value;
+        }
+    };
+    auto onSecondRecord = [&]() {
+        appendCsvRecord(buffer, row);
+        clearRow();
+        flushIfFull(output, buffer);
+    };
+    bool ok = readRecords(input, error, onSecondField, onSecondRecord);
+    flushAll(output, buffer);
+    return ok;
+}
+
+// Writes each record as a JSON object on its own line inside one array
+bool writeJsonRecords(std::istream& input, std::ostream& output, std::string& error,
+                      bool (*readRecords)(std::istream&, std::string&, const FieldCallback&, const RecordCallback&)) {
+    std::string buffer = "[";
+    std::string object;
+    bool firstRecord = true;
+
+    auto onField = [&](const std::string& column, const std::string& value) {
+        object += object.empty() ? "{" : ",";
+        appendJsonString(object, column);
+        object += ':';
+        appendJsonString(object, value);
+    };
+    auto onRecord = [&]() {
+        buffer += firstRecord ? "\n  " : ",\n  ";
+        buffer += object.empty() ? "{}" : object + "}";
+        object.clear();
+        firstRecord = false;
+        flushIfFull(output, buffer);
+    };
+
+    bool ok = readRecords(input, error, onField, onRecord);
+    buffer += firstRecord ? "]\n" : "\n]\n";
+    flushAll(output, buffer);
+    return ok;
+}
+
+// Writes each record as a <record> element with one child per field
+bool writeXmlRecords(std::istream& input, std::ostream& output, std::string& error,
+                     bool (*readRecords)(std::istream&, std::string&, const FieldCallback&, const RecordCallback&)) {
+    std::string buffer = kXmlDeclaration;
+    buffer += "<records>\n";
+    std::string record;
+
+    auto onField = [&](const std::string& column, const std::string& value) {
+        std::string name = xmlElementName(column);
+        record += "    <" + name + ">";
+        appendXmlEscaped(record, value);
+        record += "</" + name + ">\n";
+    };
+    auto onRecord = [&]() {
+        buffer += "  <record>\n";
+        buffer += record;
+        buffer += "  </record>\n";
+        record.clear();
+        flushIfFull(output, buffer);
+    };
+
+    bool ok = readRecords(input, error, onField, onRecord);
+    buffer += "</records>\n";
+    flushAll(output, buffer);
+    return ok;
+}
+
+} // namespace
+
+bool convertCsvToJson(const std::string& inputPath, const std::string& outputPath, std::string* error) {
+    return convertFile(inputPath, outputPath, error, [](std::istream& input, std::ostream& output, std::string& message) {
+        return writeJsonRecords(input, output, message, readCsvRecords);
+    });
+}
+
+bool convertCsvToXml(const std::string& inputPath, const std::string& outputPath, std::string* error) {
+    return convertFile(inputPath, outputPath, error, [](std::istream& input, std::ostream& output, std::string& message) {
+        return writeXmlRecords(input, output, message, readCsvRecords);
+    });
+}
+
+bool convertJsonToCsv(const std::string& inputPath, const std::string& outputPath, std::string* error) {
+    return convertFile(inputPath, outputPath, error, [&inputPath](std::istream&, std::ostream& output, std::string& message) {
+        return writeCsv(inputPath, output, message, readJsonRecords);
+    });
+}
+
+bool convertXmlToCsv(const std::string& inputPath, const std::string& outputPath, std::string* error) {
+    return convertFile(inputPath, outputPath, error, [&inputPath](std::istream&, std::ostream& output, std::string& message) {
+        return writeCsv(inputPath, output, message, readXmlRecords);
+    });
+}
+
+bool convertJsonToXml(const std::string& inputPath, const std::string& outputPath, std::string* error) {
+    return convertFile(inputPath, outputPath, error, [](std::istream& input, std::ostream& output, std::string& message) {
+        using Token = JsonReader::Token;
+
+        JsonReader reader(input);
+        std::string buffer = kXmlDeclaration;
+        // Open elements and whether each holds an array
+        std::vector<std::pair<std::string, bool>> stack;
+        std::string memberName;
+
+        for (;;) {
+            Token token = reader.next();
+            if (token == Token::END || token == Token::ERROR) {
+                flushAll(output, buffer);
+                message = reader.error();
+                return token == Token::END;
+            }
+            if (token == Token::KEY) {
+                memberName = xmlElementName(reader.text());
+                continue;
+            }
+
+            std::string indent(2 * stack.size(), ' ');
+            if (token == Token::END_OBJECT || token == Token::END_ARRAY) {
+                indent.resize(indent.size() - 2);
+                buffer += indent + "</" + stack.back().first + ">\n";
+                stack.pop_back();
+                flushIfFull(output, buffer);
+                continue;
+            }
+
+            // A document array is <records> holding <record> elements, any
+            // other document value is <root>; nested arrays hold <item> elements
+            std::string name;
+            if (stack.empty()) {
+                name = token == Token::BEGIN_ARRAY ? "records" : "root";
+            } else if (stack.back().second) {
+                name = stack.size() == 1 && stack.front().first == "records" ? "record" : "item";
+            } else {
+                name = memberName;
+            }
+            switch (token) {
+                case Token::BEGIN_OBJECT:
+                case Token::BEGIN_ARRAY:
+                    buffer += indent + "<" + name + ">\n";
+                    stack.emplace_back(name, token == Token::BEGIN_ARRAY);
+                    break;
+                case Token::NULL_VALUE:
+                    buffer += indent + "<" + name + "/>\n";
+                    break;
+                default:
+                    buffer += indent + "<" + name + ">";
+                    if (token == Token::TRUE_VALUE) buffer += "true";
+                    else if (token == Token::FALSE_VALUE) buffer += "false";
+                    else appendXmlEscaped(buffer, reader.text());
+                    buffer += "</" + name + ">\n";
+                    break;
+            }
+            flushIfFull(output, buffer);
+        }
+    });
+}
+
+bool convertXmlToJson(const std::string& inputPath, const std::string& outputPath, std::string* error) {
+    return convertFile(inputPath, outputPath, error, [&inputPath](std::istream& input, std::ostream& output, std::string& message) {
+        using Token = XmlReader::Token;
+
+        // A root whose children repeat one name (or are all <item> or
+        // <record>), or an empty <records>, is a list of records and is
+        // streamed one child at a time; anything else is converted as a
+        // single tree
+        bool list = false;
+        {
+            std::ifstream scan(inputPath, std::ios::binary);
+            XmlReader reader(scan);
+            std::string rootName;
+            std::string firstName;
+            std::size_t children = 0;
+            bool sameName = true;
+            bool rootAttributes = false;
+            for (Token token = reader.next(); token != Token::END; token = reader.next()) {
+                if (token == Token::ERROR) {
+                    message = reader.error();
+                    return false;
+                }
+                if (token != Token::START_ELEMENT) {
+                    continue;
+                }
+                if (reader.depth() == 1) {
+                    rootName = reader.name();
+                    rootAttributes = !reader.attributes().empty();
+                } else if (reader.depth() == 2) {
+                    if (children++ == 0) {
+                        firstName = reader.name();
+                    } else if (reader.name() != firstName) {
+                        sameName = false;
+                    }
+                }
+            }
+            list = !rootAttributes && sameName &&
+                   (children > 1 || (children == 1 && (firstName == "item" || firstName == "record")) ||
+                    (children == 0 && rootName == "records"));
+        }
+
+        XmlReader reader(input);
+        Token token = reader.next();
+        while (token == Token::TEXT) {
+            token = reader.next();
+        }
+        if (token != Token::START_ELEMENT) {
+            message = reader.error();
+            return false;
+        }
+
+        std::string buffer;
+        if (!list) {
+            // Converted as one tree
+            XmlNode root;
+            if (!readXmlNode(reader, root, message)) {
+                return false;
+            }
+            appendXmlNodeJson(root, buffer);
+            buffer += '\n';
+            flushAll(output, buffer);
+        } else {
+            buffer = "[";
+            bool first = true;
+            for (token = reader.next(); token != Token::END_ELEMENT; token = reader.next()) {
+                if (token == Token::TEXT) {
+                    continue;
+                }
+                XmlNode record;
+                if (token != Token::START_ELEMENT || !readXmlNode(reader, record, message)) {
+                    if (message.empty()) message = reader.error();
+                    return false;
+                }
+                buffer += first ? "\n  " : ",\n  ";
+                first = false;
+                appendXmlNodeJson(record, buffer);
+                flushIfFull(output, buffer);
+            }
+            buffer += first ? "]\n" : "\n]\n";
+            flushAll(output, buffer);
+        }
+        
+        if (reader.next() != Token::END) {
+            message = reader.error();
+            return false;
+        }
+        return true;
+    });
+}
+
+} // namespace converter
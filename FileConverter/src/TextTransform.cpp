@@ -0,0 +1,267 @@
+#include "TextTransform.h"
+#include "ByteReplace.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace converter {
+
+namespace {
+
+// Fallback for inputs that cannot be mapped (empty files, pipes, 32-bit limits)
+bool translateStream(std::ifstream& input, std::ofstream& output, char from, char to) {
+    // One buffer for the whole file: no per-line allocation
+    std::vector<char> buffer(kTransformChunkSize);
+    char lastByte = '\n';
+    bool empty = true;
+    
+    while (input) {
+        input.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        std::streamsize count = input.gcount();
+        if (count <= 0) {
+            break;
+        }
+        
+        replaceByte(buffer.data(), static_cast<std::size_t>(count), from, to);
+        output.write(buffer.data(), count);
+        
+        lastByte = buffer[static_cast<std::size_t>(count) - 1];
+        empty = false;
+    }
+    
+    if (input.bad()) {
+        std::cerr << "Error reading input file!" << std::endl;
+        return false;
+    }
+    
+    // Keep the old line-based behaviour of always terminating the last line
+    if (!empty && lastByte != '\n') {
+        output.put('\n');
+    }
+    
+    return true;
+}
+
+// Transforms a private copy-on-write mapping in place and writes the output
+// straight from the mapped pages: no read copy into a user buffer. Identity
+// transforms never touch the pages at all.
+void translateMapped(MappedFile& mapped, std::ofstream& output, char from, char to) {
+    mapped.adviseSequential();
+    
+    // Work in windows so transformed pages are written while still in cache
+    // and released afterwards, keeping resident memory bounded
+    const std::size_t window = kTransformChunkSize * 8;
+    for (std::size_t offset = 0; offset < mapped.size(); offset += window) {
+        std::size_t length = std::min(window, mapped.size() - offset);
+        
+        if (from != to) {
+            replaceByte(mapped.data() + offset, length, from, to);
+        }
+        output.write(mapped.data() + offset, static_cast<std::streamsize>(length));
+        mapped.adviseDone(offset, length);
+    }
+    
+    if (mapped.data()[mapped.size() - 1] != '\n') {
+        output.put('\n');
+    }
+}
+
+// Chunk size of the parallel CSV transform (8 MiB)
+constexpr std::size_t kCsvChunkSize = kTransformChunkSize * 8;
+
+bool oddQuoteCount(const char* data, std::size_t length) {
+    return (std::count(data, data + length, '"') & 1) != 0;
+}
+
+// Fallback for inputs that cannot be mapped, carrying the quote state across buffers
+bool csvToTextStream(std::ifstream& input, std::ofstream& output) {
+    std::vector<char> buffer(kTransformChunkSize);
+    std::vector<char> converted(kTransformChunkSize);
+    bool inQuotes = false;
+    char previous = '\0';
+    char lastByte = '\n';
+    bool empty = true;
+    
+    while (input) {
+        input.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        std::size_t count = static_cast<std::size_t>(input.gcount());
+        if (count == 0) {
+            break;
+        }
+        
+        std::size_t written = csvToTextChunk(buffer.data(), count, inQuotes, previous, converted.data());
+        output.write(converted.data(), static_cast<std::streamsize>(written));
+        
+        inQuotes ^= oddQuoteCount(buffer.data(), count);
+        previous = buffer[count - 1];
+        if (written > 0) {
+            lastByte = converted[written - 1];
+        }
+        empty = false;
+    }
+    
+    if (input.bad()) {
+        std::cerr << "Error reading input file!" << std::endl;
+        return false;
+    }
+    
+    if (!empty && lastByte != '\n') {
+        output.put('\n');
+    }
+    return true;
+}
+
+// Transforms the mapping in rounds of one chunk per worker: the workers count
+// quotes, the parity prefix gives each chunk its starting state, then the
+// workers transform and the results are written in order
+void csvToTextMapped(MappedFile& mapped, std::ofstream& output, std::size_t threads) {
+    const char* data = mapped.data();
+    const std::size_t size = mapped.size();
+    const std::size_t chunkCount = (size + kCsvChunkSize - 1) / kCsvChunkSize;
+    
+    std::size_t workers = std::min(threads == 0 ? ThreadPool::defaultThreadCount() : threads, chunkCount);
+    std::unique_ptr<ThreadPool> pool;
+    if (workers > 1) {
+        pool = std::make_unique<ThreadPool>(workers);
+    }
+    auto run = [&pool](std::function<void()> task) {
+        if (pool) {
+            pool->submit(std::move(task));
+        } else {
+            task();
+        }
+    };
+    
+    std::vector<std::vector<char>> outputs(workers);
+    std::vector<std::size_t> written(workers);
+    std::vector<char> odd(workers);
+    bool inQuotes = false;
+    char lastByte = '\n';
+    
+    for (std::size_t first = 0; first < chunkCount; first += workers) {
+        std::size_t round = std::min(workers, chunkCount - first);
+        auto chunkOffset = [&](std::size_t i) { return (first + i) * kCsvChunkSize; };
+        auto chunkLength = [&](std::size_t i) { return std::min(kCsvChunkSize, size - chunkOffset(i)); };
+        
+        for (std::size_t i = 0; i < round; ++i) {
+            run([&, i]() { odd[i] = oddQuoteCount(data + chunkOffset(i), chunkLength(i)); });
+        }
+        if (pool) pool->wait();
+        
+        for (std::size_t i = 0; i < round; ++i) {
+            bool startsInQuotes = inQuotes;
+            inQuotes ^= (odd[i] != 0);
+            run([&, i, startsInQuotes]() {
+                std::size_t offset = chunkOffset(i);
+                outputs[i].resize(chunkLength(i));
+                written[i] = csvToTextChunk(data + offset, chunkLength(i), startsInQuotes,
+                                            offset > 0 ? data[offset - 1] : '\0', outputs[i].data());
+            });
+        }
+        if (pool) pool->wait();
+        
+        for (std::size_t i = 0; i < round; ++i) {
+            output.write(outputs[i].data(), static_cast<std::streamsize>(written[i]));
+            if (written[i] > 0) {
+                lastByte = outputs[i][written[i] - 1];
+            }
+        }
+        mapped.adviseDone(chunkOffset(0), chunkOffset(round - 1) + chunkLength(round - 1) - chunkOffset(0));
+    }
+    
+    if (lastByte != '\n') {
+        output.put('\n');
+    }
+}
+
+} // namespace
+
+std::size_t csvToTextChunk(const char* data, std::size_t length, bool inQuotes, char previous, char* out) {
+    char* start = out;
+    std::size_t pos = 0;
+    
+    while (pos < length) {
+        // Copy the run up to the next quote; outside quotes its delimiters become spaces
+        const void* found = std::memchr(data + pos, '"', length - pos);
+        std::size_t quote = found ? static_cast<std::size_t>(static_cast<const char*>(found) - data) : length;
+        std::size_t run = quote - pos;
+        std::memcpy(out, data + pos, run);
+        if (!inQuotes) {
+            replaceByte(out, run, ',', ' ');
+        }
+        out += run;
+        if (quote == length) {
+            break;
+        }
+        
+        // A quote reopening right after a closing one is an escaped quote
+        char before = quote > 0 ? data[quote - 1] : previous;
+        if (!inQuotes && before == '"') {
+            *out++ = '"';
+        }
+        inQuotes = !inQuotes;
+        pos = quote + 1;
+    }
+    
+    return static_cast<std::size_t>(out - start);
+}
+
+bool csvToTextFile(const std::string& inputFile, const std::string& outputFile, std::size_t threads) {
+    std::ifstream input(inputFile, std::ios::binary);
+    std::ofstream output(outputFile, std::ios::binary | std::ios::trunc);
+    
+    if (!input || !output) {
+        std::cerr << "Error opening files!" << std::endl;
+        return false;
+    }
+    
+    MappedFile mapped;
+    if (mapped.open(inputFile, MappedFile::Mode::READ_ONLY)) {
+        input.close();
+        mapped.adviseSequential();
+        csvToTextMapped(mapped, output, threads);
+    } else if (!csvToTextStream(input, output)) {
+        return false;
+    }
+    
+    output.flush();
+    if (!output) {
+        std::cerr << "Error writing output file!" << std::endl;
+        return false;
+    }
+    
+    return true;
+}
+
+bool translateFile(const std::string& inputFile, const std::string& outputFile, char from, char to) {
+    std::ifstream input(inputFile, std::ios::binary);
+    std::ofstream output(outputFile, std::ios::binary | std::ios::trunc);
+    
+    if (!input || !output) {
+        std::cerr << "Error opening files!" << std::endl;
+        return false;
+    }
+    
+    MappedFile mapped;
+    if (mapped.open(inputFile, MappedFile::Mode::COPY_ON_WRITE)) {
+        input.close();
+        translateMapped(mapped, output, from, to);
+    } else if (!translateStream(input, output, from, to)) {
+        return false;
+    }
+    
+    output.flush();
+    if (!output) {
+        std::cerr << "Error writing output file!" << std::endl;
+        return false;
+    }
+    
+    return true;
+}
+
+} // namespace converter
@@ -0,0 +1,92 @@
+#include "ThreadPool.h"
+#include <exception>
+#include <iostream>
+
+namespace converter {
+
+ThreadPool::ThreadPool(std::size_t threadCount, std::size_t maxQueued) : maxQueued_(maxQueued) {
+    if (threadCount == 0) {
+        threadCount = defaultThreadCount();
+    }
+    
+    workers_.reserve(threadCount);
+    for (std::size_t i = 0; i < threadCount; ++i) {
+        workers_.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    taskAvailable_.notify_all();
+    
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (maxQueued_ > 0) {
+            spaceAvailable_.wait(lock, [this] { return tasks_.size() < maxQueued_; });
+        }
+        tasks_.push_back(std::move(task));
+    }
+    taskAvailable_.notify_one();
+}
+
+std::size_t ThreadPool::queued() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return tasks_.size();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    allDone_.wait(lock, [this] { return tasks_.empty() && activeTasks_ == 0; });
+}
+
+std::size_t ThreadPool::defaultThreadCount() {
+    unsigned int count = std::thread::hardware_concurrency();
+    return count > 0 ? count : 1;
+}
+
+void ThreadPool::workerLoop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            taskAvailable_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+            
+            // Drain the queue before honouring a stop request
+            if (tasks_.empty()) {
+                return;
+            }
+            
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+            ++activeTasks_;
+        }
+        if (maxQueued_ > 0) {
+            spaceAvailable_.notify_one();
+        }
+        
+        try {
+            task();
+        } catch (const std::exception& e) {
+            std::cerr << "Worker task failed: " << e.what() << std::endl;
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --activeTasks_;
+            if (tasks_.empty() && activeTasks_ == 0) {
+                allDone_.notify_all();
+            }
+        }
+    }
+}
+
+} // namespace converter
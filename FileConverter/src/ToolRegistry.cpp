@@ -0,0 +1,81 @@
+#include "ToolRegistry.h"
+#include <QProcess>
+#include <QStandardPaths>
+#include <QString>
+#include <QStringList>
+
+namespace converter {
+
+namespace {
+
+// ImageMagick and FFmpeg (ffprobe too) use a single dash, Pandoc and LibreOffice two
+QString versionArgument(const std::string& name) {
+    if (name == "magick" || name == "ffmpeg" || name == "ffprobe") {
+        return "-version";
+    }
+    return "--version";
+}
+
+} // namespace
+
+ToolRegistry& ToolRegistry::instance() {
+    static ToolRegistry registry;
+    return registry;
+}
+
+ToolInfo ToolRegistry::lookup(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = tools_.find(name);
+    if (it != tools_.end()) {
+        return it->second;
+    }
+
+    // Probe while holding the lock so concurrent callers never spawn the same tool twice
+    ToolInfo info = probe(name);
+    tools_[name] = info;
+    return info;
+}
+
+bool ToolRegistry::isAvailable(const std::string& name) {
+    return lookup(name).available;
+}
+
+void ToolRegistry::refresh() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tools_.clear();
+}
+
+std::vector<std::string> ToolRegistry::knownTools() {
+    return {"pandoc", "magick", "ffmpeg", "ffprobe", "soffice"};
+}
+
+ToolInfo ToolRegistry::probe(const std::string& name) {
+    ToolInfo info;
+    info.name = name;
+
+    // Resolve the executable from PATH first; a missing tool costs no process spawn
+    QString path = QStandardPaths::findExecutable(QString::fromStdString(name));
+    if (path.isEmpty()) {
+        return info;
+    }
+    info.path = path.toStdString();
+
+    QProcess process;
+    process.start(path, QStringList() << versionArgument(name));
+    if (!process.waitForFinished()) {
+        process.kill();
+        process.waitForFinished();
+        return info;
+    }
+
+    if (process.exitStatus() == QProcess::NormalExit && process.exitCode() == 0) {
+        info.available = true;
+        QString output = QString::fromLocal8Bit(process.readAllStandardOutput());
+        info.version = output.section('\n', 0, 0).trimmed().toStdString();
+    }
+
+    return info;
+}
+
+} // namespace converter
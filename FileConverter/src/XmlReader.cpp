@@ -0,0 +1,317 @@
+#include "XmlReader.h"
+#include "Utf8.h"
+#include <cstdio>
+#include <cstdlib>
+#include <istream>
+
+namespace converter {
+
+namespace {
+
+// Input is read in blocks of this size (64 KiB)
+constexpr std::size_t kXmlReadSize = 1 << 16;
+
+bool isXmlSpace(int c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+bool endsWith(const std::string& text, const char* suffix, std::size_t length) {
+    return text.size() >= length && text.compare(text.size() - length, length, suffix) == 0;
+}
+
+} // namespace
+
+XmlReader::XmlReader(std::istream& input) : input_(input), buffer_(kXmlReadSize) {}
+
+int XmlReader::peek() {
+    if (pos_ == end_) {
+        consumed_ += end_;
+        input_.read(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+        end_ = static_cast<std::size_t>(input_.gcount());
+        pos_ = 0;
+        if (end_ == 0) {
+            return EOF;
+        }
+    }
+    return static_cast<unsigned char>(buffer_[pos_]);
+}
+
+int XmlReader::get() {
+    int c = peek();
+    if (c != EOF) {
+        ++pos_;
+    }
+    return c;
+}
+
+void XmlReader::skipWhitespace() {
+    while (isXmlSpace(peek())) {
+        get();
+    }
+}
+
+XmlReader::Token XmlReader::fail(const std::string& message) {
+    if (error_.empty()) {
+        error_ = message + " at byte " + std::to_string(consumed_ + pos_);
+    }
+    done_ = true;
+    return Token::ERROR;
+}
+
+// Skips past the next occurrence of 'terminator'
+bool XmlReader::skipUntil(const char* terminator) {
+    std::size_t length = std::char_traits<char>::length(terminator);
+    std::string tail;
+    for (int c = get(); c != EOF; c = get()) {
+        tail += static_cast<char>(c);
+        if (tail.size() > length) {
+            tail.erase(0, 1);
+        }
+        if (tail == terminator) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool XmlReader::readName(std::string& name) {
+    name.clear();
+    for (int c = peek(); c != EOF && !isXmlSpace(c) && c != '/' && c != '>' && c != '<' &&
+                         c != '=' && c != '"' && c != '\''; c = peek()) {
+        name += static_cast<char>(get());
+    }
+    return !name.empty();
+}
+
+// Decodes the entity after '&' and appends it to 'out'
+bool XmlReader::readEntity(std::string& out) {
+    std::string entity;
+    for (int c = get(); c != ';'; c = get()) {
+        if (c == EOF || entity.size() > 10) {
+            return false;
+        }
+        entity += static_cast<char>(c);
+    }
+
+    if (entity == "lt") out += '<';
+    else if (entity == "gt") out += '>';
+    else if (entity == "amp") out += '&';
+    else if (entity == "quot") out += '"';
+    else if (entity == "apos") out += '\'';
+    else if (entity.size() > 1 && entity[0] == '#') {
+        bool hex = (entity[1] == 'x' || entity[1] == 'X');
+        const char* digits = entity.c_str() + (hex ? 2 : 1);
+        char* end = nullptr;
+        unsigned long codePoint = std::strtoul(digits, &end, hex ? 16 : 10);
+        if (*digits == '\0' || *end != '\0' || codePoint == 0 || codePoint > 0x10FFFF) {
+            return false;
+        }
+        appendUtf8(out, codePoint);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool XmlReader::readAttributes() {
+    attributes_.clear();
+    for (;;) {
+        skipWhitespace();
+        int c = peek();
+        if (c == '>' || c == '/' || c == EOF) {
+            return true;
+        }
+
+        std::pair<std::string, std::string> attribute;
+        if (!readName(attribute.first)) {
+            return false;
+        }
+        skipWhitespace();
+        if (get() != '=') {
+            return false;
+        }
+        skipWhitespace();
+        int quote = get();
+        if (quote != '"' && quote != '\'') {
+            return false;
+        }
+        for (c = get(); c != quote; c = get()) {
+            if (c == EOF || c == '<') {
+                return false;
+            }
+            if (c == '&') {
+                if (!readEntity(attribute.second)) {
+                    return false;
+                }
+            } else {
+                attribute.second += static_cast<char>(c);
+            }
+        }
+        attributes_.push_back(std::move(attribute));
+    }
+}
+
+XmlReader::Token XmlReader::next() {
+    if (done_) {
+        return error_.empty() ? Token::END : Token::ERROR;
+    }
+    if (pendingEnd_) {
+        pendingEnd_ = false;
+        name_ = open_.back();
+        open_.pop_back();
+        return Token::END_ELEMENT;
+    }
+
+    for (;;) {
+        int c = peek();
+
+        // Outside the root only markup and whitespace may appear
+        if (open_.empty() && c != '<') {
+            skipWhitespace();
+            c = peek();
+            if (c == EOF) {
+                if (!rootSeen_) {
+                    return fail("no root element");
+                }
+                done_ = true;
+                return input_.bad() ? fail("read error") : Token::END;
+            }
+            if (c != '<') {
+                return fail("text outside the root element");
+            }
+        }
+
+        if (c == EOF) {
+            return fail("unexpected end of input inside <" + open_.back() + ">");
+        }
+
+        // Character data up to the next tag
+        if (c != '<') {
+            text_.clear();
+            for (c = peek(); c != '<' && c != EOF; c = peek()) {
+                get();
+                if (c == '&') {
+                    if (!readEntity(text_)) {
+                        return fail("invalid entity");
+                    }
+                } else {
+                    text_ += static_cast<char>(c);
+                }
+            }
+            return Token::TEXT;
+        }
+
+        get();
+        c = peek();
+
+        if (c == '?') {
+            if (!skipUntil("?>")) {
+                return fail("unterminated processing instruction");
+            }
+            continue;
+        }
+
+        if (c == '!') {
+            get();
+            if (peek() == '-') {
+                if (get() != '-' || get() != '-' || !skipUntil("-->")) {
+                    return fail("malformed comment");
+                }
+                continue;
+            }
+            if (peek() == '[') {
+                std::string opening;
+                for (int i = 0; i < 7; ++i) {
+                    opening += static_cast<char>(get());
+                }
+                if (opening != "[CDATA[" || open_.empty()) {
+                    return fail("malformed CDATA section");
+                }
+                text_.clear();
+                while (!endsWith(text_, "]]>", 3)) {
+                    c = get();
+                    if (c == EOF) {
+                        return fail("unterminated CDATA section");
+                    }
+                    text_ += static_cast<char>(c);
+                }
+                text_.resize(text_.size() - 3);
+                return Token::TEXT;
+            }
+
+            // DOCTYPE, possibly with an internal subset in brackets
+            int brackets = 0;
+            for (c = get(); c != EOF && !(c == '>' && brackets == 0); c = get()) {
+                if (c == '[') ++brackets;
+                if (c == ']') --brackets;
+            }
+            if (c == EOF) {
+                return fail("unterminated declaration");
+            }
+            continue;
+        }
+
+        if (c == '/') {
+            get();
+            if (!readName(name_)) {
+                return fail("malformed end tag");
+            }
+            skipWhitespace();
+            if (get() != '>') {
+                return fail("malformed end tag");
+            }
+            if (open_.empty() || open_.back() != name_) {
+                return fail("unexpected </" + name_ + ">");
+            }
+            open_.pop_back();
+            return Token::END_ELEMENT;
+        }
+
+        if (open_.empty() && rootSeen_) {
+            return fail("more than one root element");
+        }
+        if (!readName(name_) || !readAttributes()) {
+            return fail("malformed start tag");
+        }
+        c = get();
+        if (c == '/') {
+            if (get() != '>') {
+                return fail("malformed start tag");
+            }
+            pendingEnd_ = true;
+        } else if (c != '>') {
+            return fail("malformed start tag");
+        }
+        open_.push_back(name_);
+        rootSeen_ = true;
+        return Token::START_ELEMENT;
+    }
+}
+
+void appendXmlEscaped(std::string& out, const std::string& text) {
+    for (char c : text) {
+        switch (c) {
+            case '&': out += "&amp;"; break;
+            case '<': out += "&lt;"; break;
+            case '>': out += "&gt;"; break;
+            case '"': out += "&quot;"; break;
+            case '\'': out += "&apos;"; break;
+            default: out += c;
+        }
+    }
+}
+
+std::string xmlElementName(const std::string& key) {
+    std::string name;
+    for (char c : key) {
+        bool valid = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                     c == '_' || c == '.' || c == '-';
+        name += valid ? c : '_';
+    }
+    if (name.empty() || (name[0] >= '0' && name[0] <= '9') || name[0] == '.' || name[0] == '-') {
+        name.insert(name.begin(), '_');
+    }
+    return name;
+}
+
+} // namespace converter
@@ -1,13 +1,296 @@
 #include "../include/FileConverter.h"
+#include "../include/BatchRunner.h"
+#include "../include/DirectorySync.h"
+#include "../include/FolderWatcher.h"
+#include "../include/ThreadPool.h"
+#include <QDir>
+#include <QFileInfo>
+#include <atomic>
+#include <chrono>
+#include <csignal>
 #include <iostream>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
 #include <string>
+#include <cstdlib>
 
 void printUsage() {
     std::cout << "Usage: FileConverter <input_file> <output_file>" << std::endl;
+    std::cout << "       FileConverter --explain <input_file> <output_file>" << std::endl;
+    std::cout << "       FileConverter --batch <list_file|directory|glob> --to <format>" << std::endl;
+    std::cout << "                     [--out-dir <dir>] [--jobs <n>] [--recursive]" << std::endl;
+    std::cout << "                     [--office-workers <n>] [--cpus <n>] [--metrics <file.jsonl|file.prom>]" << std::endl;
+    std::cout << "                     [--dry-run]" << std::endl;
+    std::cout << "                     [--cache <dir>] [--cache-size <MiB>] [--cache-hardlinks]" << std::endl;
+    std::cout << "       FileConverter --sync <directory> --to <format> --out-dir <dir>" << std::endl;
+    std::cout << "                     [--jobs <n>] [--office-workers <n>] [--cache <dir>] ..." << std::endl;
+    std::cout << "       FileConverter --watch <directory> --to <format> [--out-dir <dir>]" << std::endl;
+    std::cout << "                     [--settle <ms>] [--queue <n>] [--recursive] [--jobs <n>] ..." << std::endl;
     std::cout << "Supported formats: TXT, CSV, JSON, XML" << std::endl;
+    std::cout << "Batch, sync and watch exit codes: 0 all converted, 1 usage error, 2 some conversions failed" << std::endl;
+}
+
+// Accepts "png", ".png" or "PNG"
+converter::FileFormat parseFormat(std::string format) {
+    if (!format.empty() && format[0] != '.') {
+        format = "." + format;
+    }
+    return converter::FileConverter::detectFormat("file" + format);
+}
+
+// "FFmpeg (heavy, 1 process, 4 threads, ~12.5s): FFmpeg, no in-process converter for the pair"
+std::string describePlan(const converter::RoutePlan& plan) {
+    std::ostringstream text;
+    text << converter::backendName(plan.engine);
+    if (plan.engine != converter::Backend::NONE) {
+        text << " (" << converter::costClassName(plan.cost) << ", " << plan.processes
+             << (plan.processes == 1 ? " process" : " processes");
+        if (plan.threads > 0) {
+            text << ", " << plan.threads << (plan.threads == 1 ? " thread" : " threads");
+        }
+        if (plan.expectedSeconds >= 0.0) {
+            text << ", ~" << std::fixed << std::setprecision(2) << plan.expectedSeconds << "s";
+        }
+        text << ")";
+    }
+    text << ": " << plan.reason;
+    return text.str();
+}
+
+// Set while --watch runs so SIGINT and SIGTERM can stop it
+converter::FolderWatcher* activeWatcher = nullptr;
+
+void stopWatching(int) {
+    if (activeWatcher) {
+        activeWatcher->stop();
+    }
+}
+
+// Converts files as they are dropped into options.source until interrupted.
+// Files already there whose output is missing or older are converted first.
+// Conversions run on a pool with a bounded queue: when it is full the watcher
+// waits, and new events are held in the kernel queue meanwhile. A metrics file
+// is rewritten after every conversion.
+bool runWatch(converter::FileConverter& converter, const converter::BatchOptions& options,
+              size_t queueLimit, int settleMs, const std::string& metricsFile, size_t& failures) {
+    converter::WatchOptions watchOptions;
+    watchOptions.directory = options.source;
+    watchOptions.recursive = options.recursive;
+    watchOptions.settleMs = settleMs;
+    
+    converter::FolderWatcher watcher(watchOptions);
+    std::vector<converter::BatchItem> existing;
+    if (!watcher.start() || !converter::BatchRunner::collect(options, existing)) {
+        return false;
+    }
+    
+    size_t workers = options.jobs > 0 ? options.jobs : converter::ThreadPool::defaultThreadCount();
+    converter::ThreadPool pool(workers, queueLimit > 0 ? queueLimit : workers * 4);
+    std::mutex logMutex;
+    std::atomic<size_t> failed{0};
+    
+    // Seconds are measured from the moment the file was complete, queueing included.
+    // The watcher holds back a file that settles again until its conversion is done.
+    auto submit = [&](converter::BatchItem item) {
+        auto ready = std::chrono::steady_clock::now();
+        pool.submit([&converter, &watcher, &logMutex, &failed, &metricsFile, item, ready]() mutable {
+            item.success = converter.convert(item.inputFile, item.outputFile);
+            item.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - ready).count();
+            watcher.finished(item.inputFile);
+            
+            std::lock_guard<std::mutex> lock(logMutex);
+            if (!item.success) {
+                ++failed;
+            }
+            std::cout << (item.success ? "[ OK ] " : "[FAIL] ") << item.inputFile << " -> " << item.outputFile
+                      << " (" << std::fixed << std::setprecision(2) << item.seconds << "s)" << std::endl;
+            if (!metricsFile.empty()) {
+                converter.metrics().writeFile(metricsFile);
+            }
+        });
+    };
+    
+    for (const converter::BatchItem& item : existing) {
+        QFileInfo output(QString::fromStdString(item.outputFile));
+        if (!output.exists() || output.lastModified() < QFileInfo(QString::fromStdString(item.inputFile)).lastModified()) {
+            watcher.claim(item.inputFile);
+            submit(item);
+        }
+    }
+    
+    QDir root(QFileInfo(QString::fromStdString(options.source)).absoluteFilePath());
+    activeWatcher = &watcher;
+    std::signal(SIGINT, stopWatching);
+    std::signal(SIGTERM, stopWatching);
+    std::cout << "Watching " << options.source << " (Ctrl+C to stop)..." << std::endl;
+    
+    watcher.run([&](const std::string& path) {
+        converter::BatchItem item;
+        QString relativeDir = root.relativeFilePath(QFileInfo(QString::fromStdString(path)).absolutePath());
+        if (converter::BatchRunner::makeItem(path, options, relativeDir.toStdString(), item)) {
+            submit(item);
+        } else {
+            watcher.finished(path);
+        }
+    });
+    
+    activeWatcher = nullptr;
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+    std::cout << "Stopping, finishing queued conversions..." << std::endl;
+    pool.wait();
+    
+    failures = failed;
+    return true;
+}
+
+// Handles --batch, --sync and --watch, which share their options
+int runBatch(int argc, char* argv[]) {
+    converter::BatchOptions options;
+    bool sync = false;
+    bool watch = false;
+    size_t queueLimit = 0;
+    int settleMs = 250;
+    size_t officeWorkers = 1;
+    std::string cacheDir;
+    unsigned long long cacheMegabytes = 1024;
+    bool cacheHardLinks = false;
+    bool dryRun = false;
+    size_t cpus = converter::ThreadPool::defaultThreadCount();
+    std::string metricsFile;
+    
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        
+        if (arg == "--batch" && hasValue) {
+            options.source = argv[++i];
+        } else if (arg == "--sync" && hasValue) {
+            options.source = argv[++i];
+            sync = true;
+        } else if (arg == "--watch" && hasValue) {
+            options.source = argv[++i];
+            watch = true;
+        } else if (arg == "--queue" && hasValue) {
+            queueLimit = static_cast<size_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--settle" && hasValue) {
+            settleMs = std::atoi(argv[++i]);
+        } else if (arg == "--to" && hasValue) {
+            options.targetFormat = parseFormat(argv[++i]);
+        } else if (arg == "--out-dir" && hasValue) {
+            options.outputDir = argv[++i];
+        } else if (arg == "--jobs" && hasValue) {
+            options.jobs = static_cast<size_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--office-workers" && hasValue) {
+            officeWorkers = static_cast<size_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--cpus" && hasValue) {
+            cpus = static_cast<size_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--metrics" && hasValue) {
+            metricsFile = argv[++i];
+        } else if (arg == "--cache" && hasValue) {
+            cacheDir = argv[++i];
+        } else if (arg == "--cache-size" && hasValue) {
+            cacheMegabytes = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--cache-hardlinks") {
+            cacheHardLinks = true;
+        } else if (arg == "--dry-run") {
+            dryRun = true;
+        } else if (arg == "--recursive") {
+            options.recursive = true;
+        } else {
+            std::cerr << "Unknown or incomplete option: " << arg << std::endl;
+            printUsage();
+            return 1;
+        }
+    }
+    
+    if (options.source.empty() || options.targetFormat == converter::FileFormat::UNKNOWN ||
+        (sync && options.outputDir.empty()) || (dryRun && (sync || watch))) {
+        printUsage();
+        return 1;
+    }
+    
+    // One converter shared by every worker thread
+    converter::FileConverter converter;
+    converter.setOfficeWorkers(officeWorkers);
+    converter.setCpuBudget(cpus);
+    if (!converter.setCache(cacheDir, cacheMegabytes << 20, cacheHardLinks)) {
+        return 1;
+    }
+    
+    size_t failures = 0;
+    if (watch) {
+        if (!runWatch(converter, options, queueLimit, settleMs, metricsFile, failures)) {
+            return 1;
+        }
+        std::cout << failures << " conversions failed" << std::endl;
+    } else if (sync) {
+        converter::SyncOptions syncOptions;
+        syncOptions.sourceDir = options.source;
+        syncOptions.outputDir = options.outputDir;
+        syncOptions.targetFormat = options.targetFormat;
+        syncOptions.jobs = options.jobs;
+        
+        converter::SyncSummary summary;
+        converter::DirectorySync directorySync(converter);
+        if (!directorySync.run(syncOptions, std::cout, summary)) {
+            return 1;
+        }
+        failures = summary.failed;
+        std::cout << summary.converted << " converted, " << summary.unchanged << " unchanged, "
+                  << summary.deleted << " deleted, " << summary.failed << " failed" << std::endl;
+    } else {
+        std::vector<converter::BatchItem> items;
+        if (!converter::BatchRunner::collect(options, items)) {
+            return 1;
+        }
+        if (items.empty()) {
+            std::cout << "Nothing to convert." << std::endl;
+            return 0;
+        }
+        
+        if (dryRun) {
+            for (const converter::BatchItem& item : items) {
+                converter::RoutePlan plan = converter.explain(item.inputFile, item.outputFile);
+                std::cout << (plan.available ? "[PLAN] " : "[SKIP] ") << item.inputFile << " -> "
+                          << item.outputFile << " via " << describePlan(plan) << std::endl;
+            }
+            return 0;
+        }
+        
+        converter::BatchRunner runner(converter);
+        std::cout << "Converting " << items.size() << " files..." << std::endl;
+        failures = runner.run(items, options.jobs, std::cout);
+        std::cout << (items.size() - failures) << " converted, " << failures << " failed" << std::endl;
+    }
+    
+    if (!metricsFile.empty() && !converter.metrics().writeFile(metricsFile)) {
+        std::cerr << "Cannot write metrics file: " << metricsFile << std::endl;
+    }
+    if (!cacheDir.empty()) {
+        converter::ConversionCache::Stats cache = converter.cacheStats();
+        std::cout << "Cache: " << cache.hits << " hits, " << cache.misses << " misses, "
+                  << cache.evictions << " evicted, " << std::fixed << std::setprecision(1)
+                  << (static_cast<double>(cache.bytes) / (1 << 20)) << " MiB in "
+                  << cache.entries << " entries" << std::endl;
+    }
+    return failures == 0 ? 0 : 2;
 }
 
 int main(int argc, char* argv[]) {
+    if (argc > 1 && (std::string(argv[1]) == "--batch" || std::string(argv[1]) == "--sync" ||
+                     std::string(argv[1]) == "--watch")) {
+        return runBatch(argc, argv);
+    }
+    
+    if (argc == 4 && std::string(argv[1]) == "--explain") {
+        converter::FileConverter converter;
+        converter::RoutePlan plan = converter.explain(std::string(argv[2]), std::string(argv[3]));
+        std::cout << describePlan(plan) << std::endl;
+        return plan.available ? 0 : 1;
+    }
+    
     if (argc != 3) {
         printUsage();
         return 1;
@@ -24,6 +307,25 @@ int main(int argc, char* argv[]) {
         std::cout << "- " << converter::FileConverter::getExtension(format) << std::endl;
     }
     
+    // Show FFmpeg progress on a single, continuously rewritten line
+    converter.setProgressCallback([](const converter::ConversionProgress& progress) {
+        std::cout << "\rProgress: ";
+        if (progress.percent >= 0.0) {
+            std::cout << std::fixed << std::setprecision(1) << progress.percent << "%";
+        } else {
+            std::cout << std::fixed << std::setprecision(1) << progress.processedSeconds << "s";
+        }
+        std::cout << "  fps " << std::setprecision(1) << progress.fps
+                  << "  speed " << std::setprecision(2) << progress.speed << "x";
+        if (progress.etaSeconds >= 0.0) {
+            std::cout << "  ETA " << std::setprecision(0) << progress.etaSeconds << "s";
+        }
+        std::cout << "    " << std::flush;
+        if (progress.finished) {
+            std::cout << std::endl;
+        }
+    });
+    
     // Perform conversion
     std::cout << "Converting " << inputFile << " to " << outputFile << "..." << std::endl;
     
@@ -34,4 +336,4 @@ int main(int argc, char* argv[]) {
         std::cerr << "Conversion failed!" << std::endl;
         return 1;
     }
-}
\ No newline at end of file
+}
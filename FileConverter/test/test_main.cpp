@@ -1,8 +1,33 @@
 #include "../include/FileConverter.h"
+#include "../include/TextTransform.h"
+#include "../include/ByteReplace.h"
+#include "../include/FormatSniffer.h"
+#include "../include/JsonText.h"
+#include "../include/StructuredData.h"
+#include "../include/ContentHash.h"
+#include "../include/ConversionCache.h"
+#include "../include/DirectorySync.h"
+#include "../include/FolderWatcher.h"
+#include "../include/ResourceScheduler.h"
+#include "../include/ImageCodec.h"
+#include "../include/RemuxPlanner.h"
+#include "../include/ThreadPool.h"
+#include <QDir>
+#include <QImage>
 #include <iostream>
 #include <cassert>
 #include <fstream>
 #include <string>
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
 
 // Simple test function
 void testFormatDetection() {
@@ -43,9 +68,880 @@ void testConversion() {
     std::remove("test_output.csv");
 }
 
+// Test the chunked delimiter rewrite across chunk boundaries
+void testStreamingTranslate() {
+    std::string content(converter::kTransformChunkSize + 17, 'a');
+    for (size_t i = 0; i < content.size(); i += 7) {
+        content[i] = ' ';
+    }
+    {
+        // No trailing newline: the converter must add one
+        std::ofstream testFile("test_stream.txt", std::ios::binary);
+        testFile << content;
+    }
+    
+    bool result = converter::translateFile("test_stream.txt", "test_stream.csv", ' ', ',');
+    assert(result);
+    
+    std::ifstream output("test_stream.csv", std::ios::binary);
+    std::string converted((std::istreambuf_iterator<char>(output)), std::istreambuf_iterator<char>());
+    
+    std::string expected = content;
+    std::replace(expected.begin(), expected.end(), ' ', ',');
+    expected += '\n';
+    assert(converted == expected);
+    
+    std::cout << "Streaming translate test passed!" << std::endl;
+    
+    output.close();
+    std::remove("test_stream.txt");
+    std::remove("test_stream.csv");
+}
+
+// Every SIMD kernel must match std::replace, including unaligned tails
+void testReplaceKernels() {
+    const converter::SimdLevel levels[] = {
+        converter::SimdLevel::SCALAR, converter::SimdLevel::SSE2, converter::SimdLevel::AVX2
+    };
+    
+    for (size_t size = 0; size < 200; ++size) {
+        std::string input(size, 'x');
+        for (size_t i = 0; i < size; i += 3) {
+            input[i] = ',';
+        }
+        std::string expected = input;
+        std::replace(expected.begin(), expected.end(), ',', ' ');
+        
+        for (converter::SimdLevel level : levels) {
+            std::string data = input;
+            converter::replaceByteWith(level, &data[0], data.size(), ',', ' ');
+            assert(data == expected);
+        }
+    }
+    
+    std::cout << "Replace kernel test passed!" << std::endl;
+}
+
+// FFmpeg progress blocks may arrive split across reads
+void testFfmpegProgressParser() {
+    converter::FfmpegProgressParser parser;
+    
+    std::string log = "Input #0, matroska,webm, from 'in.mkv':\n  Duration: 00:01:40.00, start: 0.000000\n";
+    parser.feedLog(log.data(), 20);
+    parser.feedLog(log.data() + 20, log.size() - 20);
+    
+    std::string block = "frame=250\nfps=25.0\nout_time_us=50000000\nspeed=2.0x\nprogress=continue\n";
+    bool complete = parser.feedProgress(block.data(), 30);
+    assert(!complete);
+    complete = parser.feedProgress(block.data() + 30, block.size() - 30);
+    assert(complete);
+    
+    const converter::ConversionProgress& progress = parser.current();
+    assert(progress.totalSeconds == 100.0);
+    assert(progress.percent == 50.0);
+    assert(progress.fps == 25.0);
+    assert(progress.etaSeconds == 25.0);
+    
+    std::string end = "out_time_us=100000000\nprogress=end\n";
+    complete = parser.feedProgress(end.data(), end.size());
+    assert(complete);
+    assert(parser.current().finished && parser.current().percent == 100.0);
+    
+    std::cout << "FFmpeg progress parser test passed!" << std::endl;
+}
+
+void testRouteTable() {
+    using converter::Backend;
+    using converter::FileFormat;
+    
+    assert(converter::routeFor(FileFormat::TXT, FileFormat::MD) == Backend::PANDOC);
+    assert(converter::routeFor(FileFormat::PNG, FileFormat::WEBP) == Backend::IMAGEMAGICK);
+    assert(converter::routeFor(FileFormat::MKV, FileFormat::MP4) == Backend::FFMPEG);
+    assert(converter::routeFor(FileFormat::FLAC, FileFormat::MP3) == Backend::FFMPEG);
+    assert(converter::routeFor(FileFormat::PDF, FileFormat::DOCX) == Backend::LIBREOFFICE);
+    assert(converter::routeFor(FileFormat::MP3, FileFormat::PDF) == Backend::NONE);
+    assert(converter::routeFor(FileFormat::UNKNOWN, FileFormat::TXT) == Backend::NONE);
+    
+    converter::FileConverter converter;
+    auto outputs = converter.getSupportedOutputFormats(FileFormat::PNG);
+    assert(outputs.size() == 7);
+    assert(std::find(outputs.begin(), outputs.end(), FileFormat::PNG) == outputs.end());
+    assert(std::find(outputs.begin(), outputs.end(), FileFormat::JPG) != outputs.end());
+    
+    auto inputs = converter.getSupportedFormats();
+    assert(inputs.size() == converter::kFormatCount - 1);
+    assert(inputs.front() == FileFormat::TXT);
+    
+    std::cout << "Route table test passed!" << std::endl;
+}
+
+void testContentSniffing() {
+    using converter::FileFormat;
+    auto sniff = [](const std::string& bytes) {
+        return converter::sniffFormat(reinterpret_cast<const unsigned char*>(bytes.data()), bytes.size()).format;
+    };
+    
+    assert(sniff(std::string("\x89PNG\r\n\x1A\n", 8)) == FileFormat::PNG);
+    assert(sniff("\xFF\xD8\xFF\xE0") == FileFormat::JPG);
+    assert(sniff("%PDF-1.4") == FileFormat::PDF);
+    assert(sniff(std::string("RIFF\0\0\0\0WAVE", 12)) == FileFormat::WAV);
+    assert(sniff(std::string("\0\0\0\x18" "ftypqt  ", 12)) == FileFormat::MOV);
+    assert(sniff(std::string("PK\x03\x04", 4) + std::string(26, '\0') + "word/document.xml") == FileFormat::DOCX);
+    assert(sniff("  {\"key\": 1}") == FileFormat::JSON);
+    assert(sniff("BMW, Audi, Opel") == FileFormat::UNKNOWN);
+    assert(sniff("plain words") == FileFormat::UNKNOWN);
+    
+    // Content overrides the extension only when the two disagree
+    {
+        std::ofstream file("sniff_test.txt", std::ios::binary);
+        file << "%PDF-1.7\n";
+    }
+    assert(converter::FileConverter::detectInputFormat("sniff_test.txt") == FileFormat::PDF);
+    {
+        std::ofstream file("sniff_test.md", std::ios::binary);
+        file << "[link](target)\n";
+    }
+    assert(converter::FileConverter::detectInputFormat("sniff_test.md") == FileFormat::MD);
+    assert(converter::FileConverter::detectInputFormat("missing_file.csv") == FileFormat::CSV);
+    std::remove("sniff_test.txt");
+    std::remove("sniff_test.md");
+    
+    std::cout << "Content sniffing test passed!" << std::endl;
+}
+
+void testJsonText() {
+    {
+        std::ofstream json("test_input.json");
+        json << "{\"name\": \"Ann\", \"tags\": [\"a\", [1, 2.5]], \"info\": {\"ok\": true, \"none\": null}}";
+    }
+    bool result = converter::renderJsonTextFile("test_input.json", "test_json.txt");
+    assert(result);
+    
+    std::ifstream output("test_json.txt");
+    std::string text((std::istreambuf_iterator<char>(output)), std::istreambuf_iterator<char>());
+    output.close();
+    assert(text == "name: Ann\n"
+                   "tags: \n"
+                   "  - a\n"
+                   "  - \n"
+                   "    - 1\n"
+                   "    - 2.5\n"
+                   "info: \n"
+                   "  ok: true\n"
+                   "  none: null\n");
+    
+    // Malformed input leaves no output behind
+    {
+        std::ofstream json("test_input.json");
+        json << "{\"name\": [1, 2}";
+    }
+    std::string error;
+    result = converter::renderJsonTextFile("test_input.json", "test_json.txt", &error);
+    assert(!result);
+    assert(!error.empty());
+    assert(!std::ifstream("test_json.txt").good());
+    
+    // Nesting far deeper than any call stack would allow
+    {
+        std::ofstream json("test_input.json");
+        json << std::string(10000, '[') << std::string(10000, ']');
+    }
+    std::ifstream deep("test_input.json");
+    std::ostream discard(nullptr);
+    error.clear();
+    converter::renderJsonText(deep, discard, &error);
+    assert(error.empty());
+    
+    std::remove("test_input.json");
+    std::remove("test_json.txt");
+    
+    std::cout << "JSON text rendering test passed!" << std::endl;
+}
+
+void testEnginePreference() {
+    using converter::Engine;
+    using converter::FileFormat;
+    
+    converter::FileConverter converter;
+    assert(converter.hasNativeConverter(FileFormat::JSON, FileFormat::TXT));
+    assert(!converter.hasNativeConverter(FileFormat::PNG, FileFormat::JPG));
+    assert(converter.enginePreference(FileFormat::JSON, FileFormat::TXT) == Engine::NATIVE);
+    assert(converter.enginePreference(FileFormat::TXT, FileFormat::CSV) == Engine::NATIVE);
+    
+    converter.setEnginePreference(FileFormat::JSON, FileFormat::TXT, Engine::EXTERNAL);
+    assert(converter.enginePreference(FileFormat::JSON, FileFormat::TXT) == Engine::EXTERNAL);
+    converter.setEnginePreference(FileFormat::JSON, FileFormat::TXT, Engine::NATIVE);
+    
+    // The default JSON to TXT route never needs Pandoc
+    {
+        std::ofstream json("test_engine.json");
+        json << "{\"a\": [1, 2]}";
+    }
+    bool result = converter.convert("test_engine.json", "test_engine.txt");
+    assert(result);
+    std::ifstream output("test_engine.txt");
+    std::string text((std::istreambuf_iterator<char>(output)), std::istreambuf_iterator<char>());
+    output.close();
+    assert(text == "a: \n  - 1\n  - 2\n");
+    
+    // explain() reports the same choice without converting
+    converter::RoutePlan plan = converter.explain("test_engine.json", "test_engine.txt");
+    assert(plan.engine == converter::Backend::NATIVE && plan.available && plan.processes == 0);
+    assert(plan.expectedSeconds >= 0.0);
+    assert(converter.explain(FileFormat::TXT, FileFormat::CSV).engine == converter::Backend::NATIVE);
+    
+    plan = converter.explain(FileFormat::PNG, FileFormat::JPG);
+    assert(plan.engine == converter::Backend::IMAGEMAGICK && plan.processes == 1);
+    assert(plan.cost == converter::CostClass::MEDIUM && plan.expectedSeconds < 0.0);
+    assert(converter.explain(FileFormat::MP3, FileFormat::MP4).engine == converter::Backend::NONE);
+    
+    converter.setEnginePreference(FileFormat::TXT, FileFormat::CSV, Engine::EXTERNAL);
+    plan = converter.explain(FileFormat::TXT, FileFormat::CSV);
+    assert(plan.engine == (converter.isToolAvailable("pandoc") ? converter::Backend::PANDOC : converter::Backend::NATIVE));
+    
+    std::remove("test_engine.json");
+    std::remove("test_engine.txt");
+    
+    std::cout << "Engine preference test passed!" << std::endl;
+}
+
+std::string readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+void testStructuredData() {
+    const std::string csv =
+        "name,note\n"
+        "Ann,\"says \"\"hi\"\", then left\"\n"
+        "Bob,\"two\nlines\"\n";
+    {
+        std::ofstream file("test_data.csv", std::ios::binary);
+        file << csv;
+    }
+    
+    bool converted = converter::convertCsvToJson("test_data.csv", "test_data.json");
+    assert(converted);
+    assert(readFile("test_data.json") ==
+           "[\n"
+           "  {\"name\":\"Ann\",\"note\":\"says \\\"hi\\\", then left\"},\n"
+           "  {\"name\":\"Bob\",\"note\":\"two\\nlines\"}\n"
+           "]\n");
+    
+    // Every pair round-trips the table
+    converted = converter::convertJsonToCsv("test_data.json", "test_back.csv");
+    assert(converted);
+    assert(readFile("test_back.csv") == csv);
+    converted = converter::convertCsvToXml("test_data.csv", "test_data.xml");
+    assert(converted);
+    converted = converter::convertXmlToCsv("test_data.xml", "test_back.csv");
+    assert(converted);
+    assert(readFile("test_back.csv") == csv);
+    converted = converter::convertXmlToJson("test_data.xml", "test_back.json");
+    assert(converted);
+    assert(readFile("test_back.json") == readFile("test_data.json"));
+    converted = converter::convertJsonToXml("test_data.json", "test_back.xml");
+    assert(converted);
+    converted = converter::convertXmlToJson("test_back.xml", "test_back.json");
+    assert(converted);
+    assert(readFile("test_back.json") == readFile("test_data.json"));
+    
+    // Rows with different keys share one header
+    {
+        std::ofstream file("test_data.json");
+        file << "[{\"a\": 1}, {\"b\": true, \"a\": null}, {\"c\": [1, 2]}]";
+    }
+    converted = converter::convertJsonToCsv("test_data.json", "test_back.csv");
+    assert(converted);
+    assert(readFile("test_back.csv") == "a,b,c\n1,,\n,true,\n,,\"[1,2]\"\n");
+    
+    // Blank lines are not records
+    {
+        std::ofstream file("test_data.csv", std::ios::binary);
+        file << "a,b\n\n1,2\r\n\n";
+    }
+    converted = converter::convertCsvToJson("test_data.csv", "test_data.json");
+    assert(converted);
+    assert(readFile("test_data.json") == "[\n  {\"a\":\"1\",\"b\":\"2\"}\n]\n");
+    
+    // A JSON array of records becomes <records>; empty containers come back empty
+    converted = converter::convertJsonToXml("test_data.json", "test_back.xml");
+    assert(converted);
+    assert(readFile("test_back.xml").find("<records>\n  <record>\n") != std::string::npos);
+    {
+        std::ofstream file("test_data.json");
+        file << "{\"a\": [], \"b\": {}}";
+    }
+    converted = converter::convertJsonToXml("test_data.json", "test_back.xml") &&
+                converter::convertXmlToJson("test_back.xml", "test_back.json");
+    assert(converted);
+    assert(readFile("test_back.json") == "{\"a\":\"\",\"b\":\"\"}\n");
+    {
+        std::ofstream file("test_data.json");
+        file << "[]";
+    }
+    converted = converter::convertJsonToXml("test_data.json", "test_back.xml") &&
+                converter::convertXmlToJson("test_back.xml", "test_back.json");
+    assert(converted);
+    assert(readFile("test_back.json") == "[]\n");
+    
+    // Malformed input fails and leaves no output
+    {
+        std::ofstream file("test_data.xml");
+        file << "<records><record><a>1</record></records>";
+    }
+    std::string error;
+    converted = converter::convertXmlToJson("test_data.xml", "test_back.json", &error);
+    assert(!converted);
+    assert(!error.empty());
+    assert(!std::ifstream("test_back.json").good());
+    
+    for (const char* path : {"test_data.csv", "test_data.json", "test_data.xml",
+                             "test_back.csv", "test_back.json", "test_back.xml"}) {
+        std::remove(path);
+    }
+    
+    std::cout << "Structured data test passed!" << std::endl;
+}
+
+// Test quote-aware CSV to text, split at every position and across threads
+void testCsvToText() {
+    const std::string csv = "a,\"b,c\",d\n\"say \"\"hi\"\"\",\"x\ny\"\n\"\"\"\"\"\",e\n";
+    const std::string expected = "a b,c d\nsay \"hi\" x\ny\n\"\" e\n";
+    
+    std::string whole(csv.size(), '\0');
+    whole.resize(converter::csvToTextChunk(csv.data(), csv.size(), false, '\0', &whole[0]));
+    assert(whole == expected);
+    
+    // Each half starts with the quote parity and last byte of the data before it
+    for (size_t split = 0; split <= csv.size(); ++split) {
+        std::string out(csv.size(), '\0');
+        size_t written = converter::csvToTextChunk(csv.data(), split, false, '\0', &out[0]);
+        bool inQuotes = (std::count(csv.begin(), csv.begin() + split, '"') & 1) != 0;
+        written += converter::csvToTextChunk(csv.data() + split, csv.size() - split, inQuotes,
+                                             split > 0 ? csv[split - 1] : '\0', &out[written]);
+        out.resize(written);
+        assert(out == whole);
+    }
+    
+    // Several chunks: a quoted field straddles every chunk boundary
+    {
+        std::ofstream file("test_data.csv", std::ios::binary);
+        std::string row = "1,\"quoted, \"\"field\"\"\",3\n";
+        for (size_t size = 0; size < converter::kTransformChunkSize * 20; size += row.size()) {
+            file << row;
+        }
+        file << "last,row";
+    }
+    bool converted = converter::csvToTextFile("test_data.csv", "test_serial.txt", 1);
+    assert(converted);
+    converted = converter::csvToTextFile("test_data.csv", "test_parallel.txt", 4);
+    assert(converted);
+    std::string serial = readFile("test_serial.txt");
+    assert(serial.compare(0, 26, "1 quoted, \"field\" 3\n1 quot") == 0);
+    assert(serial.size() >= 9 && serial.compare(serial.size() - 9, 9, "last row\n") == 0);
+    assert(readFile("test_parallel.txt") == serial);
+    
+    for (const char* path : {"test_data.csv", "test_serial.txt", "test_parallel.txt"}) {
+        std::remove(path);
+    }
+    
+    std::cout << "CSV to text test passed!" << std::endl;
+}
+
+// Test the content hash and the conversion cache
+void testConversionCache() {
+    // XXH64 reference values
+    assert(converter::hashBytes("", 0) == 0xEF46DB3751D8E999ULL);
+    assert(converter::hashBytes("abc", 3) == 0x44BC2CF5AD770999ULL);
+    std::string data(1000, 'x');
+    converter::ContentHasher hasher;
+    for (size_t i = 0; i < data.size(); i += 7) {
+        hasher.update(data.data() + i, std::min<size_t>(7, data.size() - i));
+    }
+    assert(hasher.digest() == converter::hashBytes(data.data(), data.size()));
+    
+    // A second input with the same content is served from the cache
+    for (const char* path : {"test_a.txt", "test_b.txt"}) {
+        std::ofstream file(path, std::ios::binary);
+        file << "one two\n";
+    }
+    {
+        converter::FileConverter converter;
+        bool ok = converter.setCache("test_cache", 1 << 20);
+        assert(ok);
+        ok = converter.convert("test_a.txt", "test_a.csv");
+        assert(ok);
+        ok = converter.convert("test_b.txt", "test_b.csv");
+        assert(ok);
+        assert(readFile("test_b.csv") == readFile("test_a.csv"));
+        converter::ConversionCache::Stats stats = converter.cacheStats();
+        assert(stats.hits == 1 && stats.misses == 1 && stats.stores == 1 && stats.entries == 1);
+    }
+    
+    // Least recently used entries go first once the size limit is exceeded
+    {
+        converter::ConversionCache cache("test_cache_lru", 10);
+        assert(cache.isValid());
+        std::string first = cache.makeKey("test_a.txt", ".csv", "first");
+        std::string second = cache.makeKey("test_a.txt", ".csv", "second");
+        assert(first.size() == 32 && first != second);
+        bool ok = cache.store(first, "test_a.txt");
+        assert(ok);
+        ok = cache.store(second, "test_b.txt");
+        assert(ok);
+        ok = cache.fetch(first, "test_c.txt");
+        assert(!ok);
+        ok = cache.fetch(second, "test_c.txt");
+        assert(ok);
+        assert(readFile("test_c.txt") == "one two\n");
+        assert(cache.stats().evictions == 1 && cache.stats().bytes == 8);
+        
+        // Even with hard links allowed, editing a stored output leaves its entry alone
+        cache.setHardLinks(true);
+        ok = cache.store(first, "test_a.txt");
+        assert(ok);
+        std::ofstream("test_a.txt", std::ios::binary | std::ios::app) << "three\n";
+        ok = cache.fetch(first, "test_c.txt");
+        assert(ok);
+        assert(readFile("test_c.txt") == "one two\n");
+    }
+
+    for (const char* path : {"test_a.txt", "test_b.txt", "test_c.txt", "test_a.csv", "test_b.csv"}) {
+        std::remove(path);
+    }
+    QDir("test_cache").removeRecursively();
+    QDir("test_cache_lru").removeRecursively();
+    
+    std::cout << "Conversion cache test passed!" << std::endl;
+}
+
+// Test that sync converts only new and changed files and removes stale outputs
+void testDirectorySync() {
+    QDir().mkpath("test_sync_src/sub");
+    {
+        std::ofstream a("test_sync_src/a.txt", std::ios::binary);
+        a << "one two\n";
+        std::ofstream b("test_sync_src/sub/b.txt", std::ios::binary);
+        b << "three four\n";
+    }
+    
+    converter::FileConverter converter;
+    converter.setEnginePreference(converter::FileFormat::TXT, converter::FileFormat::CSV, converter::Engine::NATIVE);
+    converter::DirectorySync sync(converter);
+    converter::SyncOptions options;
+    options.sourceDir = "test_sync_src";
+    options.outputDir = "test_sync_out";
+    options.targetFormat = converter::FileFormat::CSV;
+    std::ostringstream log;
+    converter::SyncSummary summary;
+    
+    bool ok = sync.run(options, log, summary);
+    assert(ok);
+    assert(summary.converted == 2 && summary.unchanged == 0);
+    assert(readFile("test_sync_out/sub/b.csv") == "three,four\n");
+    
+    ok = sync.run(options, log, summary);
+    assert(ok);
+    assert(summary.converted == 0 && summary.unchanged == 2);
+    
+    {
+        std::ofstream a("test_sync_src/a.txt", std::ios::binary);
+        a << "one two three\n";
+    }
+    ok = sync.run(options, log, summary);
+    assert(ok);
+    assert(summary.converted == 1 && summary.unchanged == 1);
+    assert(readFile("test_sync_out/a.csv") == "one,two,three\n");
+    
+    std::remove("test_sync_src/sub/b.txt");
+    ok = sync.run(options, log, summary);
+    assert(ok);
+    assert(summary.deleted == 1 && summary.unchanged == 1);
+    assert(!std::ifstream("test_sync_out/sub/b.csv").good());
+    assert(!QDir("test_sync_out/sub").exists());
+    
+    QDir("test_sync_src").removeRecursively();
+    QDir("test_sync_out").removeRecursively();
+    
+    std::cout << "Directory sync test passed!" << std::endl;
+}
+
+// Test that a bounded pool blocks producers while its queue is full
+void testThreadPoolBackpressure() {
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<int> completed{0};
+    auto task = [&completed, released] {
+        released.wait();
+        ++completed;
+    };
+    
+    // One task runs and blocks, two fill the queue
+    converter::ThreadPool pool(1, 2);
+    for (int i = 0; i < 3; ++i) {
+        pool.submit(task);
+    }
+    
+    std::atomic<bool> submitted{false};
+    std::thread producer([&] {
+        pool.submit(task);
+        submitted = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    assert(!submitted);
+    
+    release.set_value();
+    producer.join();
+    pool.wait();
+    assert(submitted && completed == 4);
+    
+    std::cout << "Thread pool backpressure test passed!" << std::endl;
+}
+
+// Test that a dropped file is reported once, after its last write, and that a
+// rewrite during its conversion is reported again only once that finished
+void testFolderWatcher() {
+    QDir().mkpath("test_watch");
+    converter::WatchOptions options;
+    options.directory = "test_watch";
+    options.settleMs = 200;
+    converter::FolderWatcher watcher(options);
+    bool started = watcher.start();
+    assert(started);
+    
+    // Written in two sessions, as tools that reopen a file to append do
+    std::thread writer([] {
+        {
+            std::ofstream file("test_watch/drop.txt", std::ios::binary);
+            file << "part one ";
+        }
+        std::ofstream file("test_watch/drop.txt", std::ios::binary | std::ios::app);
+        file << "part two\n";
+    });
+    
+    // Stops the watcher if nothing is reported, so a missed event fails instead of hanging
+    std::atomic<bool> done{false};
+    std::thread timeout([&watcher, &done] {
+        for (int i = 0; i < 100 && !done; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        watcher.stop();
+    });
+    
+    std::vector<std::string> reported;
+    std::vector<std::string> contents;
+    std::atomic<bool> finished{false};
+    bool reportedAfterFinish = false;
+    std::thread converting;
+    watcher.run([&](const std::string& path) {
+        reported.push_back(path);
+        contents.push_back(readFile(path));
+        if (reported.size() > 1) {
+            reportedAfterFinish = finished;
+            watcher.stop();
+            return;
+        }
+        // Rewritten while "converting"; the conversion takes longer than the settle time
+        std::ofstream(path, std::ios::binary | std::ios::app) << "part three\n";
+        converting = std::thread([&watcher, &finished, path] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(600));
+            finished = true;
+            watcher.finished(path);
+        });
+    });
+    done = true;
+    writer.join();
+    timeout.join();
+    if (converting.joinable()) {
+        converting.join();
+    }
+    
+    assert(reported.size() == 2 && reported[0] == reported[1] && reportedAfterFinish);
+    assert(reported[0].size() >= 8 && reported[0].compare(reported[0].size() - 8, 8, "drop.txt") == 0);
+    assert(contents[0] == "part one part two\n");
+    assert(contents[1] == "part one part two\npart three\n");
+    
+    QDir("test_watch").removeRecursively();
+    
+    std::cout << "Folder watcher test passed!" << std::endl;
+}
+
+// Test that the core budget is never exceeded and requests are served in order
+void testResourceScheduler() {
+    using converter::CostClass;
+    assert(converter::costClassFor(converter::Backend::FFMPEG, converter::FileFormat::MP4) == CostClass::HEAVY);
+    assert(converter::costClassFor(converter::Backend::FFMPEG, converter::FileFormat::MP3) == CostClass::LIGHT);
+    assert(converter::costClassFor(converter::Backend::IMAGEMAGICK, converter::FileFormat::PNG) == CostClass::MEDIUM);
+    assert(converter::costClassFor(converter::Backend::NATIVE, converter::FileFormat::CSV) == CostClass::LIGHT);
+    
+    converter::ResourceScheduler scheduler(4);
+    assert(scheduler.threadBudget(CostClass::LIGHT) == 1);
+    assert(scheduler.threadBudget(CostClass::HEAVY) == 2);
+    scheduler.setThreadBudget(CostClass::HEAVY, 16);
+    assert(scheduler.threadBudget(CostClass::HEAVY) == 4);
+    scheduler.setThreadBudget(CostClass::HEAVY, 3);
+    
+    std::vector<int> order;
+    std::mutex orderMutex;
+    auto record = [&order, &orderMutex](int id) {
+        std::lock_guard<std::mutex> lock(orderMutex);
+        order.push_back(id);
+    };
+    
+    auto heavy = std::make_unique<converter::ResourceScheduler::Lease>(scheduler.acquire(CostClass::HEAVY));
+    assert(heavy->threads() == 3 && scheduler.inUse() == 3);
+    
+    // MEDIUM does not fit next to HEAVY; LIGHT would, but must not overtake it
+    std::thread medium([&] {
+        converter::ResourceScheduler::Lease lease = scheduler.acquire(CostClass::MEDIUM);
+        record(1);
+        assert(scheduler.inUse() <= 4);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    std::thread light([&] {
+        converter::ResourceScheduler::Lease lease = scheduler.acquire(CostClass::LIGHT);
+        record(2);
+        assert(scheduler.inUse() <= 4);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    assert(order.empty());
+    
+    record(0);
+    heavy.reset();
+    medium.join();
+    light.join();
+    
+    assert(order.size() == 3 && order[0] == 0);
+    assert(scheduler.inUse() == 0);
+    
+    std::cout << "Resource scheduler test passed!" << std::endl;
+}
+
+// Test that conversions are counted per route, with phases and failure reasons
+void testConversionMetrics() {
+    converter::FileConverter converter;
+    {
+        std::ofstream file("test_metrics.csv", std::ios::binary);
+        file << "a,b\n1,2\n";
+    }
+    bool converted = converter.convert("test_metrics.csv", "test_metrics.json");
+    assert(converted);
+    converted = converter.convert("test_metrics.csv", "test_metrics.xyz");
+    assert(!converted);
+    
+    auto routes = converter.metrics().snapshot();
+    const converter::RouteMetrics& native = routes.at({"csv", "json", "native"});
+    assert(native.conversions == 1 && native.failures == 0);
+    assert(native.bytesIn == 8 && native.bytesOut == readFile("test_metrics.json").size());
+    assert(native.phases[static_cast<std::size_t>(converter::Phase::PROBE)].count() == 1);
+    assert(native.phases[static_cast<std::size_t>(converter::Phase::RUN)].count() == 1);
+    assert(native.phases[static_cast<std::size_t>(converter::Phase::SPAWN)].count() == 0);
+    
+    const converter::RouteMetrics& unsupported = routes.at({"csv", "unknown", "none"});
+    assert(unsupported.failures == 1);
+    assert(unsupported.failureReasons.at(converter::FailureReason::UNSUPPORTED) == 1);
+    
+    std::ostringstream jsonStream;
+    converter.metrics().writeJsonLines(jsonStream);
+    std::string json = jsonStream.str();
+    assert(json.find("{\"from\":\"csv\",\"to\":\"json\",\"engine\":\"native\",\"conversions\":1,") !=
+           std::string::npos);
+    assert(std::count(json.begin(), json.end(), '\n') == 2);
+    
+    std::ostringstream prometheus;
+    converter.metrics().writePrometheus(prometheus);
+    assert(prometheus.str().find("fileconverter_conversions_total{from=\"csv\",to=\"json\",engine=\"native\"} 1\n") !=
+           std::string::npos);
+    assert(prometheus.str().find("reason=\"unsupported\"} 1\n") != std::string::npos);
+    assert(prometheus.str().find("phase=\"run\",le=\"+Inf\"} 1\n") != std::string::npos);
+    
+    std::remove("test_metrics.csv");
+    std::remove("test_metrics.json");
+    
+    std::cout << "Conversion metrics test passed!" << std::endl;
+}
+
+// Test that raster pairs run in-process, flattening transparency where needed
+void testImageConversion() {
+    using converter::FileFormat;
+    // PNG reading and BMP writing are built into Qt, no plugin needed
+    assert(converter::qtCanConvertImage(FileFormat::PNG, FileFormat::BMP));
+    assert(!converter::qtCanConvertImage(FileFormat::SVG, FileFormat::PNG));
+    
+    QImage image(8, 4, QImage::Format_ARGB32);
+    image.fill(Qt::transparent);
+    image.setPixel(1, 1, qRgba(255, 0, 0, 255));
+    bool ok = image.save("test_image.png");
+    assert(ok);
+    
+    converter::FileConverter converter;
+    assert(converter.explain("test_image.png", "test_image.bmp").engine == converter::Backend::NATIVE);
+    ok = converter.convert("test_image.png", "test_image.bmp");
+    assert(ok);
+    
+    QImage result;
+    ok = result.load("test_image.bmp");
+    assert(ok);
+    assert(result.width() == 8 && result.height() == 4);
+    assert(result.pixel(1, 1) == qRgb(255, 0, 0));
+    assert(result.pixel(0, 0) == qRgb(255, 255, 255));
+    
+    // Icons larger than the ICO format allows are left to ImageMagick
+    assert(converter::qtAcceptsImage("test_image.png", FileFormat::ICO));
+    QImage large(300, 300, QImage::Format_RGB32);
+    large.fill(Qt::white);
+    ok = large.save("test_large.png");
+    assert(ok);
+    assert(!converter::qtAcceptsImage("test_large.png", FileFormat::ICO));
+    
+    for (const char* path : {"test_image.png", "test_image.bmp", "test_large.png"}) {
+        std::remove(path);
+    }
+    
+    std::cout << "Image conversion test passed!" << std::endl;
+}
+
+// Test the image pipeline, its fallbacks and the batched ImageMagick path
+void testImageBatch() {
+    // Two sizes, so workers both reuse and replace their buffers
+    std::vector<converter::ConversionJob> jobs;
+    for (int i = 0; i < 6; ++i) {
+        QImage image(i % 2 ? 16 : 24, 8, QImage::Format_ARGB32);
+        image.fill(Qt::transparent);
+        image.setPixel(0, 0, qRgba(0, 0, 255, 255));
+        std::string name = "test_batch_" + std::to_string(i);
+        bool saved = image.save(QString::fromStdString(name + ".png"));
+        assert(saved);
+        jobs.push_back({name + ".png", name + ".bmp"});
+    }
+    // Not an image: falls back to convert(); missing input: fails alone
+    std::ofstream("test_batch.txt") << "a b\n";
+    jobs.push_back({"test_batch.txt", "test_batch.csv"});
+    jobs.push_back({"test_batch_missing.png", "test_batch_missing.bmp"});
+    
+    converter::FileConverter converter;
+    std::vector<int> calls(jobs.size(), 0);
+    std::vector<bool> results = converter.convertImages(jobs, 2,
+        [&calls](std::size_t index, bool, double seconds) {
+            assert(seconds >= 0.0);
+            ++calls[index];
+        });
+    
+    assert(results.size() == jobs.size());
+    for (std::size_t i = 0; i < jobs.size(); ++i) {
+        assert(calls[i] == 1);
+        assert(results[i] == (i + 1 < jobs.size()));
+    }
+    for (int i = 0; i < 6; ++i) {
+        QImage result;
+        bool loaded = result.load(QString::fromStdString("test_batch_" + std::to_string(i) + ".bmp"));
+        assert(loaded);
+        assert(result.width() == (i % 2 ? 16 : 24));
+        assert(result.pixel(0, 0) == qRgb(0, 0, 255));
+        assert(result.pixel(1, 0) == qRgb(255, 255, 255));
+    }
+    assert(readFile("test_batch.csv") == "a,b\n");
+    assert(!std::ifstream("test_batch_missing.bmp"));
+    // The missing input counts under ImageMagick instead when that is installed
+    converter::RouteMetrics route = converter.metrics().route({"png", "bmp", "native"});
+    assert(route.conversions - route.failures == 6);
+    
+    // Preferring ImageMagick sends the images through one mogrify run
+    if (converter.isToolAvailable("magick")) {
+        converter::FileConverter external;
+        external.setEnginePreference(converter::FileFormat::PNG, converter::FileFormat::BMP,
+                                     converter::Engine::EXTERNAL);
+        std::vector<converter::ConversionJob> images(jobs.begin(), jobs.begin() + 6);
+        for (const converter::ConversionJob& job : images) {
+            std::remove(job.outputFile.c_str());
+        }
+        std::vector<bool> viaMagick = external.convertImages(images, 2);
+        assert(std::count(viaMagick.begin(), viaMagick.end(), true) == 6);
+        assert(std::ifstream("test_batch_5.bmp"));
+        assert(external.metrics().route({"png", "bmp", "ImageMagick"}).conversions == 6);
+    }
+    
+    for (int i = 0; i < 6; ++i) {
+        std::string name = "test_batch_" + std::to_string(i);
+        std::remove((name + ".png").c_str());
+        std::remove((name + ".bmp").c_str());
+    }
+    std::remove("test_batch.txt");
+    std::remove("test_batch.csv");
+    
+    std::cout << "Image batch test passed!" << std::endl;
+}
+
+// Test which streams can be copied into which container
+void testRemuxPlanner() {
+    using converter::FileFormat;
+    std::vector<converter::MediaStream> streams = converter::parseProbeStreams(
+        "codec_name=h264|codec_type=video\r\n"
+        "codec_type=audio|codec_name=aac\n"
+        "codec_name=subrip|codec_type=subtitle\n"
+        "codec_name=ttf|codec_type=attachment\n");
+    assert(streams.size() == 4);
+    assert(streams[0].type == "video" && streams[0].codec == "h264");
+    assert(streams[1].type == "audio" && streams[1].codec == "aac");
+    
+    // Matroska takes the subtitles as they are, MP4 would need them encoded
+    std::string reason;
+    assert(converter::canStreamCopy(streams, FileFormat::MKV));
+    bool copyable = converter::canStreamCopy(streams, FileFormat::MP4, &reason);
+    assert(!copyable);
+    assert(reason == "subtitle stream subrip needs encoding");
+    streams.erase(streams.begin() + 2);
+    assert(converter::canStreamCopy(streams, FileFormat::MP4));
+    assert(converter::canStreamCopy(streams, FileFormat::M4V));
+    assert(!converter::canStreamCopy(streams, FileFormat::WEBM));
+    
+    // Audio outputs leave the video out, but need an audio stream
+    assert(converter::canStreamCopy(streams, FileFormat::AAC));
+    assert(!converter::canStreamCopy(streams, FileFormat::MP3));
+    copyable = converter::canStreamCopy({{"video", "h264"}}, FileFormat::AAC, &reason);
+    assert(!copyable);
+    assert(reason == "no audio stream");
+    assert(converter::streamCopyOptions(FileFormat::AAC).front() == "-vn");
+    assert(converter::streamCopyOptions(FileFormat::MP4) == std::vector<std::string>({"-c", "copy"}));
+    
+    assert(converter::containerAccepts(FileFormat::WAV, "pcm_s24le"));
+    assert(!converter::containerAccepts(FileFormat::MKV, ""));
+    assert(converter::mayStreamCopy(FileFormat::MKV, FileFormat::MP4));
+    assert(converter::mayStreamCopy(FileFormat::WAV, FileFormat::MOV));
+    assert(!converter::mayStreamCopy(FileFormat::WAV, FileFormat::MP3));
+    assert(!converter::mayStreamCopy(FileFormat::PNG, FileFormat::MP4));
+    
+    // explain() counts ffprobe among the processes of a pair that may copy
+    converter::FileConverter converter;
+    converter::RoutePlan plan = converter.explain(FileFormat::MKV, FileFormat::MP4);
+    bool probes = plan.available && converter.isToolAvailable("ffprobe");
+    assert(plan.processes == (probes ? 2u : 1u));
+    
+    std::cout << "Remux planner test passed!" << std::endl;
+}
+
 int main() {
     testFormatDetection();
     testConversion();
+    testStreamingTranslate();
+    testReplaceKernels();
+    testFfmpegProgressParser();
+    testRouteTable();
+    testContentSniffing();
+    testJsonText();
+    testEnginePreference();
+    testStructuredData();
+    testCsvToText();
+    testConversionCache();
+    testDirectorySync();
+    testThreadPoolBackpressure();
+    testFolderWatcher();
+    testResourceScheduler();
+    testConversionMetrics();
+    testImageConversion();
+    testImageBatch();
+    testRemuxPlanner();
     
     std::cout << "All tests passed!" << std::endl;
     return 0;